@@ -10,8 +10,20 @@
 #include "hardware/pwm.h"
 #include "hardware/clocks.h"
 #include "pico/cyw43_arch.h"
-#include "lwip/tcp.h"
-#include "song.h"
+#include "inc/http_server.h"
+#include "inc/notify.h"
+#include "inc/discovery.h"
+#include "inc/mem_guard.h"
+#include "inc/buttons.h"
+#include "inc/scheduler.h"
+#include "inc/melody.h"
+#include "inc/tone_filter.h"
+#include "inc/policy.h"
+#include "inc/song.h"
+#include "inc/flash_store.h"
+#include "inc/ui.h"
+#include "inc/auth.h"
+#include "inc/ota.h"
 
 
 // Configurações de pinos
@@ -29,29 +41,102 @@ const uint LED_BLUE_PIN = 12;
 #define WIFI_SSID "nome da rede wifi"
 #define WIFI_PASS "senha da rede wifi"
 
+// Token da API até ser trocado por POST /auth/token (o novo fica gravado na flash)
+#define API_TOKEN "troque-este-token"
+
+// Notificações (broker MQTT ou servidor HTTP da rede local)
+#define NOTIFY_PROTO NOTIFY_PROTO_MQTT
+#define NOTIFY_HOST "192.168.0.10"
+#define NOTIFY_PORT 1883
+#define NOTIFY_PATH "baba/eventos"  // Tópico MQTT ou caminho do POST HTTP
+
+// Identificação do dispositivo na rede (acessível como baba-<comodo>.local)
+#define DEVICE_ROOM "quarto"
+#define DEVICE_ID "baba-" DEVICE_ROOM
+
 // Configurações do ADC para detecção de som
-const float SOUND_OFFSET = 1.65; 
-const float SOUND_THRESHOLD = 0.18; 
+const float SOUND_THRESHOLD = 0.18;         // Valor padrão até a primeira calibração
+const float SOUND_THRESHOLD_MIN = 0.08;     // Limiar mínimo aceito pela calibração
+const float CALIBRATION_MARGIN = 2.8;       // Limiar = margem x nível médio do ruído (~4 desvios padrão)
+const uint CALIBRATION_BLOCKS = 20;         // Um bloco por SAMPLE_WINDOW_MS (~1 s no total)
 const float ADC_REF = 3.3;         
 const int ADC_RES = 4095;          
+const float ADC_SAMPLE_RATE = 16000.0f;     // Taxa do bloco capturado pelo FIFO do ADC
+#define ADC_BLOCK_SAMPLES 128               // 8 ms por janela de amostragem
 
-const uint DETECTION_DURATION_MS = 10000; 
+const uint DETECTION_DURATION_MS = 10000;  // Janela longa de atividade
+const uint SHORT_WINDOW_MS = 2000;         // Janela curta, no mesmo buffer circular
 const uint SAMPLE_WINDOW_MS = 50;         
-const uint MIN_ACTIVE_SAMPLES = 10;
 
-static uint32_t sample_buffer[200] = {0};  // Buffer circular para 10s
-static uint sample_index = 0;
-static uint active_samples_count = 0;
+const uint MEM_REPORT_INTERVAL_MS = 60000;  // Relatório periódico de memória no serial
+const uint32_t NOTIFY_MUTE_MS = 30 * 60 * 1000;  // Toque longo em B silencia as notificações
+
+// Períodos e prioridades das tarefas do escalonador (maior prioridade executa primeiro)
+const uint BUTTONS_PERIOD_MS = 10;
+const uint STATUS_PERIOD_MS = 50;
+const uint NETWORK_PERIOD_MS = 20;
+enum {
+    PRIORITY_REPORT = 0,
+    PRIORITY_DISPLAY = 0,
+    PRIORITY_STATUS = 1,
+    PRIORITY_NETWORK = 1,
+    PRIORITY_SAMPLING = 2,
+    PRIORITY_BUTTONS = 3
+};
+
+static float sound_threshold = SOUND_THRESHOLD;
+
+// Acumuladores da calibração em andamento
+static int calibration_task = -1;
+static uint calibration_count = 0;
+static float calibration_sum = 0.0f;
+
+// Custo do cancelamento do tom por bloco (GET /stats)
+static uint32_t tone_filter_us = 0;
+static uint32_t tone_filter_us_max = 0;
+
+static uint16_t adc_block[ADC_BLOCK_SAMPLES];
+
+static policy_window_t activity;  // Janelas de 2 s e 10 s
+
+// Motor de resposta (níveis de melodia, volume e notificação)
+static policy_t policy;
+
+// Alterações de GET /policy: feitas no contexto do lwIP sobre esta cópia e aplicadas
+// pela tarefa de amostragem (apply_policy_changes), que é quem lê a política
+static policy_tier_t policy_staged_tiers[POLICY_MAX_TIERS];
+static uint32_t policy_staged_quiet_ms;
+static uint8_t policy_staged_quiet_pct;
+static volatile bool policy_staged_pending = false;
 
 static absolute_time_t detection_start_time;
 static uint sound_detection_count = 0;
 static bool is_detecting = false;
 
+// Display: telas e widgets (inc/ui.c)
+enum {
+    SCREEN_LIVE = 0,     // Nível ao vivo e histórico de atividade
+    SCREEN_SUMMARY       // Resumo da noite, exibido ao desativar
+};
+static int ui_icon_wifi, ui_icon_mute, ui_icon_note, ui_icon_alert;
+static int ui_state, ui_message;
+static int ui_headline, ui_level, ui_activity, ui_history;
+static int ui_night, ui_cries, ui_longest, ui_melody;
+
+// Resumo da noite (reiniciado a cada ativação)
+static uint32_t night_start_ms = 0;
+static uint night_cries = 0;
+static uint32_t night_episode_start_ms = 0;
+static uint32_t night_longest_ms = 0;
+static uint32_t night_melody_ms = 0;
+static bool night_in_episode = false;
+
 // Estado do sistema
 volatile bool system_active = false;
-volatile bool melody_active = false;
 volatile bool cry_detected = false;  
 
+static scheduler_t scheduler;
+
 
 // HTML
 #define HTTP_RESPONSE "HTTP/1.1 200 OK\r\n" \
@@ -87,58 +172,367 @@ volatile bool cry_detected = false;
                       "</body>" \
                       "</html>\r\n"
 
-// Funções do Webserver
-static err_t http_callback(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
-    if (p == NULL) {
-        tcp_close(tpcb);
-        return ERR_OK;
+// Rotas que alteram o estado exigem o token; responde 401/429 e retorna false se recusado.
+// Com o token padrão do firmware só a troca do token (allow_default) é aceita; as demais dão 403.
+static bool require_auth(const http_request_t *request, http_response_t *response, bool allow_default) {
+    auth_result_t result = auth_check(request, to_ms_since_boot(get_absolute_time()));
+    if (result == AUTH_OK && !allow_default && auth_is_default()) {
+        result = AUTH_DEFAULT;
+    }
+    if (result != AUTH_OK) {
+        auth_write_denied(response, result);
+        return false;
     }
+    return true;
+}
 
-    char *request = (char *)p->payload;
-    if (strstr(request, "GET /system/on")) {
-        system_active = true;
-    } else if (strstr(request, "GET /system/off")) {
-        system_active = false;
-        melody_active = false;
-        cry_detected = false;
+// GET /policy lista os níveis de resposta; com parâmetros altera um nível em tempo de execução
+// (ex.: /policy?tier=2&long=20&volume=70) ou o silêncio (quiet_ms, quiet_pct). Roda no contexto
+// do lwIP: altera só a cópia em policy_staged_*, aplicada na próxima janela de amostragem.
+static void handle_policy_request(const http_request_t *request, http_response_t *response) {
+    if (request->query[0] != '\0' && !require_auth(request, response, false)) {
+        return;
     }
 
-    // Gerar resposta dinâmica com buffer maior
-    char http_response[2048];  // Aumentado para 2KB
-    const char *alert = cry_detected ? "<div class='alert'>Choro detectado!</div>" : "";
-    
-    int len = snprintf(
-        http_response, 
-        sizeof(http_response),
-        HTTP_RESPONSE,
-        alert
-    );
+    long value;
+    if (http_query_int(request->query, "quiet_ms", &value)) {
+        if (value < 0) {
+            http_response_printf(response, "HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n");
+            return;
+        }
+        policy_staged_quiet_ms = value;
+        policy_staged_pending = true;
+    }
+    if (http_query_int(request->query, "quiet_pct", &value)) {
+        if (value < 0 || value > 100) {
+            http_response_printf(response, "HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n");
+            return;
+        }
+        policy_staged_quiet_pct = value;
+        policy_staged_pending = true;
+    }
 
-    tcp_write(tpcb, http_response, len < 2048 ? len : 2047, TCP_WRITE_FLAG_COPY);
-    pbuf_free(p);
-    return ERR_OK;
+    long index;
+    if (http_query_int(request->query, "tier", &index)) {
+        if (index < 1 || index > POLICY_MAX_TIERS) {
+            http_response_printf(response, "HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n");
+            return;
+        }
+        // Valida todos os campos antes de alterar o nível
+        policy_tier_t tier = policy_staged_tiers[index - 1];
+        bool valid = true;
+        if (http_query_int(request->query, "short", &value)) {
+            valid &= value >= 0 && value <= 100;
+            tier.min_short_pct = value;
+        }
+        if (http_query_int(request->query, "long", &value)) {
+            valid &= value >= 0 && value <= 100;
+            tier.min_long_pct = value;
+        }
+        if (http_query_int(request->query, "track", &value)) {
+            valid &= value >= 0 && value < (long)song_library_count();
+            tier.track = value;
+        }
+        if (http_query_int(request->query, "volume", &value)) {
+            valid &= value >= 0 && value <= MELODY_VOLUME_MAX;
+            tier.volume = value;
+        }
+        if (http_query_int(request->query, "loop", &value)) {
+            tier.loop = value != 0;
+        }
+        if (http_query_int(request->query, "notify", &value)) {
+            tier.notify = value != 0;
+        }
+        if (!valid) {
+            http_response_printf(response, "HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n");
+            return;
+        }
+        policy_staged_tiers[index - 1] = tier;
+        policy_staged_pending = true;
+    }
+
+    http_response_printf(response, "HTTP/1.1 200 OK\r\n"
+                                   "Content-Type: application/json\r\n"
+                                   "Connection: close\r\n\r\n"
+                                   "{\"level\":%d,\"quiet_ms\":%lu,\"quiet_pct\":%d,\"tiers\":[",
+                         policy.level, (unsigned long)policy_staged_quiet_ms, policy_staged_quiet_pct);
+    for (int i = 0; i < POLICY_MAX_TIERS; i++) {
+        const policy_tier_t *tier = &policy_staged_tiers[i];
+        http_response_printf(response, "%s{\"tier\":%d,\"name\":\"%s\",\"short\":%d,\"long\":%d,"
+                                       "\"track\":\"%s\",\"volume\":%d,\"loop\":%s,\"notify\":%s}",
+                             i ? "," : "", i + 1, tier->name, tier->min_short_pct, tier->min_long_pct,
+                             song_library_get(tier->track) ? song_name(song_library_get(tier->track)) : "",
+                             tier->volume,
+                             tier->loop ? "true" : "false", tier->notify ? "true" : "false");
+    }
+    http_response_printf(response, "]}");
 }
 
-static err_t connection_callback(void *arg, struct tcp_pcb *newpcb, err_t err) {
-    tcp_recv(newpcb, http_callback);
-    return ERR_OK;
+// GET /songs: faixas da biblioteca (embutidas e slots da flash)
+static void handle_songs_request(http_response_t *response) {
+    http_response_printf(response, "HTTP/1.1 200 OK\r\n"
+                                   "Content-Type: application/json\r\n"
+                                   "Connection: close\r\n\r\n[");
+    for (uint i = 0; i < song_library_count(); i++) {
+        const uint8_t *song = song_library_get(i);
+        http_response_printf(response, "%s{\"track\":%u,", i ? "," : "", i);
+        if (i >= song_builtin_count) {
+            http_response_printf(response, "\"slot\":%u,", i - song_builtin_count);
+        }
+        if (song != NULL) {
+            http_response_printf(response, "\"name\":\"%s\",\"notes\":%u}", song_name(song), song_note_count(song));
+        } else {
+            http_response_printf(response, "\"name\":null}");
+        }
+    }
+    http_response_printf(response, "]");
 }
 
-static void start_http_server(void) {
-    struct tcp_pcb *pcb = tcp_new();
-    tcp_bind(pcb, IP_ADDR_ANY, 80);
-    pcb = tcp_listen(pcb);
-    tcp_accept(pcb, connection_callback);
+// POST /songs?slot=N: recebe uma faixa gerada por tools/songc.py --bin e grava no slot da flash
+// (write e end rodam no http_server_poll, fora do contexto do lwIP)
+static uint8_t song_upload_buffer[FLASH_STORE_SONG_SLOT_SIZE];
+static uint32_t song_upload_len = 0;
+static long song_upload_slot = -1;  // -1 = nenhum upload em andamento
+
+static bool song_upload_begin(const http_request_t *request, http_response_t *response) {
+    if (!require_auth(request, response, false)) {
+        return false;
+    }
+    long slot;
+    if (!http_query_int(request->query, "slot", &slot) || slot < 0 || slot >= FLASH_STORE_SONG_SLOTS) {
+        http_response_printf(response, "HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n");
+        return false;
+    }
+    if (request->content_length > sizeof(song_upload_buffer)) {
+        http_response_printf(response, "HTTP/1.1 413 Payload Too Large\r\nConnection: close\r\n\r\n");
+        return false;
+    }
+    // A melodia lê a faixa direto da flash: não regrava enquanto toca
+    if (song_upload_slot >= 0 || melody_is_playing()) {
+        http_response_printf(response, "HTTP/1.1 409 Conflict\r\nConnection: close\r\n\r\n");
+        return false;
+    }
+    song_upload_slot = slot;
+    song_upload_len = 0;
+    return true;
 }
 
-// Inicialização do PWM para o buzzer
-void pwm_init_buzzer(uint pin) {
-    gpio_set_function(pin, GPIO_FUNC_PWM);
-    uint slice_num = pwm_gpio_to_slice_num(pin);
-    pwm_config config = pwm_get_default_config();
-    pwm_config_set_clkdiv(&config, 4.0f); 
-    pwm_init(slice_num, &config, true);
-    pwm_set_gpio_level(pin, 0); 
+static bool song_upload_write(const uint8_t *data, uint16_t len) {
+    memcpy(song_upload_buffer + song_upload_len, data, len);
+    song_upload_len += len;
+    return true;
+}
+
+static void song_upload_end(const http_request_t *request, http_response_t *response) {
+    long slot = song_upload_slot;
+    song_upload_slot = -1;
+    if (response == NULL) {
+        return;  // Conexão perdida: nada é gravado
+    }
+    if (!song_validate(song_upload_buffer, song_upload_len)) {
+        http_response_printf(response, "HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n");
+        return;
+    }
+    if (melody_is_playing() || !song_library_store(slot, song_upload_buffer, song_upload_len)) {
+        http_response_printf(response, "HTTP/1.1 500 Internal Server Error\r\nConnection: close\r\n\r\n");
+        return;
+    }
+    printf("Faixa '%s' gravada no slot %ld\n", song_name(song_upload_buffer), slot);
+    http_response_printf(response, "HTTP/1.1 200 OK\r\n"
+                                   "Content-Type: application/json\r\n"
+                                   "Connection: close\r\n\r\n"
+                                   "{\"track\":%lu,\"name\":\"%s\"}",
+                         (unsigned long)(song_builtin_count + slot), song_name(song_upload_buffer));
+}
+
+static const http_upload_route_t song_upload_route = {
+    .path = "/songs",
+    .begin = song_upload_begin,
+    .write = song_upload_write,
+    .end = song_upload_end
+};
+
+// POST /auth/token: o corpo é o novo token (exige o token atual; aceita o padrão do firmware).
+// A gravação na flash (auth_set_token) roda no http_server_poll, fora do contexto do lwIP.
+static char token_upload_buffer[AUTH_TOKEN_MAX];
+static uint32_t token_upload_len = 0;
+static bool token_upload_busy = false;
+
+static bool token_upload_begin(const http_request_t *request, http_response_t *response) {
+    if (!require_auth(request, response, true)) {
+        return false;
+    }
+    if (request->content_length < AUTH_TOKEN_MIN || request->content_length > AUTH_TOKEN_MAX) {
+        http_response_printf(response, "HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n");
+        return false;
+    }
+    if (token_upload_busy) {
+        http_response_printf(response, "HTTP/1.1 409 Conflict\r\nConnection: close\r\n\r\n");
+        return false;
+    }
+    token_upload_busy = true;
+    token_upload_len = 0;
+    return true;
+}
+
+static bool token_upload_write(const uint8_t *data, uint16_t len) {
+    memcpy(token_upload_buffer + token_upload_len, data, len);
+    token_upload_len += len;
+    return true;
+}
+
+static void token_upload_end(const http_request_t *request, http_response_t *response) {
+    token_upload_busy = false;
+    if (response == NULL) {
+        return;
+    }
+    if (!auth_set_token(token_upload_buffer, token_upload_len)) {
+        http_response_printf(response, "HTTP/1.1 500 Internal Server Error\r\nConnection: close\r\n\r\n");
+        return;
+    }
+    printf("Token da API alterado\n");
+    http_response_printf(response, "HTTP/1.1 204 No Content\r\nConnection: close\r\n\r\n");
+}
+
+static const http_upload_route_t token_upload_route = {
+    .path = "/auth/token",
+    .begin = token_upload_begin,
+    .write = token_upload_write,
+    .end = token_upload_end
+};
+
+// POST /ota: imagem nova (build/baba_eletronica.bin) gravada em fluxo no slot B.
+// O cabeçalho X-SHA256 traz o hash esperado; o bootloader troca os slots no reinício.
+static bool ota_upload_begin(const http_request_t *request, http_response_t *response) {
+    if (!require_auth(request, response, false)) {
+        return false;
+    }
+    char hex[2 * SHA256_DIGEST_SIZE + 1];
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    if (!http_request_header(request, "X-SHA256", hex, sizeof(hex)) || !ota_parse_digest(hex, digest)) {
+        http_response_printf(response, "HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n");
+        return false;
+    }
+    if (request->content_length > OTA_SLOT_SIZE) {
+        http_response_printf(response, "HTTP/1.1 413 Payload Too Large\r\nConnection: close\r\n\r\n");
+        return false;
+    }
+    if (!ota_begin(request->content_length, digest)) {
+        http_response_printf(response, "HTTP/1.1 409 Conflict\r\nConnection: close\r\n\r\n");
+        return false;
+    }
+    return true;
+}
+
+static bool ota_upload_write(const uint8_t *data, uint16_t len) {
+    return ota_write(data, len);
+}
+
+static void ota_upload_end(const http_request_t *request, http_response_t *response) {
+    if (response == NULL) {
+        ota_abort();
+        return;
+    }
+    switch (ota_end()) {
+    case OTA_UPLOAD_OK:
+        http_response_printf(response, "HTTP/1.1 202 Accepted\r\n"
+                                       "Content-Type: application/json\r\n"
+                                       "Connection: close\r\n\r\n");
+        ota_write_status(response);
+        break;
+    case OTA_UPLOAD_BAD_HASH:
+    case OTA_UPLOAD_BAD_IMAGE:
+    case OTA_UPLOAD_INCOMPLETE:
+        http_response_printf(response, "HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n");
+        break;
+    default:
+        http_response_printf(response, "HTTP/1.1 500 Internal Server Error\r\nConnection: close\r\n\r\n");
+        break;
+    }
+}
+
+static const http_upload_route_t ota_upload_route = {
+    .path = "/ota",
+    .begin = ota_upload_begin,
+    .write = ota_upload_write,
+    .end = ota_upload_end
+};
+
+// Rotas do webserver (a conexão e o envio ficam em inc/http_server.c)
+static void handle_http_request(const http_request_t *request, http_response_t *response) {
+    if (strcmp(request->method, "GET") != 0) {
+        http_response_printf(response, "HTTP/1.1 405 Method Not Allowed\r\nConnection: close\r\n\r\n");
+        return;
+    }
+
+    if (strcmp(request->path, "/stats") == 0) {
+        http_response_printf(response, "HTTP/1.1 200 OK\r\n"
+                                       "Content-Type: application/json\r\n"
+                                       "Connection: close\r\n\r\n");
+        uint32_t core0_used, core0_size, core1_used, core1_size;
+        mem_guard_stack_usage(0, &core0_used, &core0_size);
+        mem_guard_stack_usage(1, &core1_used, &core1_size);
+        http_response_printf(response, "{\"net\":");
+        http_server_write_stats(response);
+        http_response_printf(response, ",\"stack\":{\"core0_used\":%lu,\"core0_size\":%lu,"
+                                       "\"core1_used\":%lu,\"core1_size\":%lu},"
+                                       "\"heap_ops_after_boot\":%lu,\"tasks\":[",
+                             (unsigned long)core0_used, (unsigned long)core0_size,
+                             (unsigned long)core1_used, (unsigned long)core1_size,
+                             (unsigned long)mem_guard_heap_ops_after_boot());
+        for (int i = 0, n = 0; i < SCHED_MAX_TASKS; i++) {
+            const sched_task_t *task = sched_get_task(&scheduler, i);
+            if (task == NULL) {
+                continue;
+            }
+            http_response_printf(response, "%s{\"name\":\"%s\",\"runs\":%lu,\"avg_us\":%lu,"
+                                           "\"max_us\":%lu,\"max_late_us\":%lu,\"overruns\":%lu}",
+                                 n++ ? "," : "", task->name, (unsigned long)task->runs,
+                                 (unsigned long)(task->runs ? task->total_us / task->runs : 0),
+                                 (unsigned long)task->max_us, (unsigned long)task->max_late_us,
+                                 (unsigned long)task->overruns);
+        }
+        http_response_printf(response, "],\"tone_filter\":{\"us\":%lu,\"us_max\":%lu},"
+                                       "\"display_bytes\":%lu,\"auth\":",
+                             (unsigned long)tone_filter_us, (unsigned long)tone_filter_us_max,
+                             (unsigned long)ui_bytes_sent());
+        auth_write_stats(response);
+        http_response_printf(response, "}");
+        return;
+    }
+
+    if (strcmp(request->path, "/songs") == 0) {
+        handle_songs_request(response);
+        return;
+    }
+
+    if (strcmp(request->path, "/policy") == 0) {
+        handle_policy_request(request, response);
+        return;
+    }
+
+    if (strcmp(request->path, "/ota") == 0) {
+        http_response_printf(response, "HTTP/1.1 200 OK\r\n"
+                                       "Content-Type: application/json\r\n"
+                                       "Connection: close\r\n\r\n");
+        ota_write_status(response);
+        return;
+    }
+
+    bool system_route = strcmp(request->path, "/system/on") == 0 || strcmp(request->path, "/system/off") == 0;
+    if (system_route && !require_auth(request, response, false)) {
+        return;
+    }
+    if (strcmp(request->path, "/system/on") == 0) {
+        system_active = true;
+    } else if (strcmp(request->path, "/system/off") == 0) {
+        system_active = false;
+        melody_request_stop();
+        cry_detected = false;
+    }
+
+    const char *alert = cry_detected ? "<div class='alert'>Choro detectado!</div>" : "";
+    http_response_printf(response, HTTP_RESPONSE, alert);
 }
 
 // Configuração dos LEDs de estado
@@ -173,43 +567,332 @@ void update_led_status(bool active, bool sound_detected) {
     }
 }
 
-// Tocar uma nota
-void play_tone(uint pin, uint frequency, uint duration_ms) {
-    uint slice_num = pwm_gpio_to_slice_num(pin);
-    uint32_t clock_freq = clock_get_hz(clk_sys);
-    uint32_t top = clock_freq / frequency - 1;
+// Captura um bloco do microfone pelo FIFO do ADC em modo contínuo
+static void capture_block(void) {
+    adc_fifo_drain();
+    adc_run(true);
+    for (uint i = 0; i < ADC_BLOCK_SAMPLES; i++) {
+        adc_block[i] = adc_fifo_get_blocking();
+    }
+    adc_run(false);
+    adc_fifo_drain();
+}
+
+// Captura um bloco e retorna o nível residual com o tom do buzzer cancelado.
+// A nota pode mudar durante a captura: cancela as duas.
+static float measure_sound_level(void) {
+    uint32_t tones[TONE_FILTER_MAX_TONES];
+    tones[0] = melody_current_frequency();
+    capture_block();
+    tones[1] = melody_current_frequency();
+
+    uint32_t start_us = time_us_32();
+    float level = tone_filter_residual_level(adc_block, ADC_BLOCK_SAMPLES, ADC_SAMPLE_RATE,
+                                             tones, TONE_FILTER_MAX_TONES, ADC_REF / ADC_RES);
+    tone_filter_us = time_us_32() - start_us;
+    if (tone_filter_us > tone_filter_us_max) {
+        tone_filter_us_max = tone_filter_us;
+    }
+    return level;
+}
+
+// Tarefa de calibração: mede um bloco por execução, com a mesma estatística da detecção
+// (nível residual de measure_sound_level), e se cancela ao terminar
+static void calibration_step(void *ctx) {
+    calibration_sum += measure_sound_level();
+    if (++calibration_count < CALIBRATION_BLOCKS) {
+        return;
+    }
 
-    pwm_set_wrap(slice_num, top);
-    pwm_set_gpio_level(pin, top / 2); 
+    sched_cancel(&scheduler, calibration_task);
+    calibration_task = -1;
 
-    sleep_ms(duration_ms);
-    pwm_set_gpio_level(pin, 0); 
-    sleep_ms(30);
+    float noise = calibration_sum / CALIBRATION_BLOCKS;
+    sound_threshold = fmaxf(SOUND_THRESHOLD_MIN, CALIBRATION_MARGIN * noise);
+    printf("Calibracao: ruido %.3f V | limiar %.3f V\n", noise, sound_threshold);
+    ui_set_text(ui_message, "Calibrado");
 }
 
-// Reproduzir melodia
-void play_melody(uint pin) {
-    melody_active = true;
-    while (melody_active) {
-        for (int i = 0; i < sizeof(melody_notes)/sizeof(melody_notes[0]); i++) {
-            if (!melody_active) break;
-            play_tone(pin, melody_notes[i], melody_durations[i]);
-            if (gpio_get(BUTTON_B_PIN) == 0) {
-                melody_active = false;
-                break;
+// Mede o ruído ambiente para ajustar o limiar de detecção
+void calibrate_noise(void) {
+    if (calibration_task >= 0) {
+        return;
+    }
+    ui_set_text(ui_message, "Calibrando...");
+
+    calibration_count = 0;
+    calibration_sum = 0.0f;
+    calibration_task = sched_add_periodic(&scheduler, "calibracao", SAMPLE_WINDOW_MS,
+                                          PRIORITY_SAMPLING, calibration_step, NULL);
+}
+
+// Trata os gestos dos botões enfileirados pelas interrupções
+void handle_button_events(void) {
+    gesture_t gesture;
+    while (buttons_get_event(&gesture)) {
+        uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+        switch (gesture) {
+        case GESTURE_A_CLICK:
+            system_active = true;
+            break;
+        case GESTURE_A_DOUBLE:
+            calibrate_noise();
+            break;
+        case GESTURE_B_CLICK:
+            system_active = false;
+            melody_request_stop();
+            cry_detected = false;
+            break;
+        case GESTURE_B_LONG:
+            // Alterna o silêncio das notificações
+            notify_mute(notify_is_muted(now_ms) ? 0 : NOTIFY_MUTE_MS, now_ms);
+            ui_set_text(ui_message, notify_is_muted(now_ms) ? "Alertas mudos" : "Alertas ativos");
+            break;
+        case GESTURE_AB_HOLD:
+            ui_set_text(ui_message, "%s", ip4addr_ntoa(netif_ip4_addr(&cyw43_state.netif[CYW43_ITF_STA])));
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+// Uso máximo das pilhas e do heap, enviado pelo serial
+static void print_mem_report(void) {
+    uint32_t core0_used, core0_size, core1_used, core1_size;
+    mem_guard_stack_usage(0, &core0_used, &core0_size);
+    mem_guard_stack_usage(1, &core1_used, &core1_size);
+    printf("Pilha: nucleo 0 %lu/%lu B | nucleo 1 %lu/%lu B | heap apos boot: %lu\n",
+           (unsigned long)core0_used, (unsigned long)core0_size,
+           (unsigned long)core1_used, (unsigned long)core1_size,
+           (unsigned long)mem_guard_heap_ops_after_boot());
+
+    for (int i = 0; i < SCHED_MAX_TASKS; i++) {
+        const sched_task_t *task = sched_get_task(&scheduler, i);
+        if (task != NULL) {
+            printf("Tarefa %-10s execucoes %lu | media %lu us | max %lu us | atraso max %lu us | estouros %lu\n",
+                   task->name, (unsigned long)task->runs,
+                   (unsigned long)(task->runs ? task->total_us / task->runs : 0),
+                   (unsigned long)task->max_us, (unsigned long)task->max_late_us,
+                   (unsigned long)task->overruns);
+        }
+    }
+}
+
+// Limpa o histórico de detecção e volta a resposta ao repouso
+static void reset_detection(void) {
+    policy_window_init(&activity, DETECTION_DURATION_MS / SAMPLE_WINDOW_MS, SHORT_WINDOW_MS / SAMPLE_WINDOW_MS);
+    policy_reset(&policy);
+}
+
+// Aplica as alterações de GET /policy; o lwIP fica bloqueado durante a cópia para que
+// uma requisição simultânea não deixe um nível pela metade
+static void apply_policy_changes(void) {
+    if (!policy_staged_pending) {
+        return;
+    }
+    cyw43_arch_lwip_begin();
+    memcpy(policy.tiers, policy_staged_tiers, sizeof(policy.tiers));
+    policy.quiet_ms = policy_staged_quiet_ms;
+    policy.quiet_pct = policy_staged_quiet_pct;
+    policy_staged_pending = false;
+    cyw43_arch_lwip_end();
+    printf("Politica de resposta atualizada\n");
+}
+
+// ---------- Tarefas do escalonador ----------
+
+static void buttons_task(void *ctx) {
+    handle_button_events();
+}
+
+// Atualiza LEDs e telas quando o estado muda
+static void status_task(void *ctx) {
+    static bool previous_state = false;
+    if (system_active != previous_state) {
+        uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+        reset_detection();
+        update_led_status(system_active, false);
+        notify_push(system_active ? NOTIFY_EVT_ACTIVATED : NOTIFY_EVT_DEACTIVATED, 0, now_ms);
+        ui_set_text(ui_state, system_active ? "Ativo" : "Desligado");
+        if (system_active) {
+            // Nova noite: zera o resumo e volta à tela ao vivo
+            night_start_ms = now_ms;
+            night_cries = 0;
+            night_longest_ms = 0;
+            night_melody_ms = 0;
+            night_in_episode = false;
+            ui_set_text(ui_headline, "Sistema ativado");
+            ui_show(SCREEN_LIVE);
+        } else {
+            ui_show(SCREEN_SUMMARY);
+        }
+        previous_state = system_active;
+    }
+}
+
+// Fim de um episódio de choro (silêncio ou desativação)
+static void night_episode_end(uint32_t now_ms) {
+    if (night_in_episode) {
+        night_in_episode = false;
+        if (now_ms - night_episode_start_ms > night_longest_ms) {
+            night_longest_ms = now_ms - night_episode_start_ms;
+        }
+    }
+}
+
+// Ícones da barra de status, resumo da noite e envio do quadro (limitado a 10 fps pelo ui_render)
+static void display_task(void *ctx) {
+    static uint32_t last_ms = 0;
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    if (melody_is_playing()) {
+        night_melody_ms += now_ms - last_ms;
+    }
+    last_ms = now_ms;
+    if (!system_active) {
+        night_episode_end(now_ms);
+    }
+
+    ui_set_icon(ui_icon_wifi, cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA) == CYW43_LINK_UP ?
+                              UI_ICON_WIFI : UI_ICON_NONE);
+    ui_set_icon(ui_icon_mute, notify_is_muted(now_ms) ? UI_ICON_MUTE : UI_ICON_NONE);
+    ui_set_icon(ui_icon_note, melody_is_playing() ? UI_ICON_NOTE : UI_ICON_NONE);
+    ui_set_icon(ui_icon_alert, cry_detected ? UI_ICON_ALERT : UI_ICON_NONE);
+
+    uint32_t night_min = (system_active ? now_ms - night_start_ms : 0) / 60000;
+    ui_set_text(ui_night, "Noite: %02lu:%02lu", (unsigned long)(night_min / 60), (unsigned long)(night_min % 60));
+    ui_set_text(ui_cries, "Choros: %u", night_cries);
+    ui_set_text(ui_longest, "Maior: %02lu:%02lu", (unsigned long)(night_longest_ms / 60000),
+                (unsigned long)(night_longest_ms / 1000 % 60));
+    ui_set_text(ui_melody, "Melodia: %02lu:%02lu", (unsigned long)(night_melody_ms / 60000),
+                (unsigned long)(night_melody_ms / 1000 % 60));
+
+    ui_render(now_ms);
+}
+
+// Detecção de som: um bloco por janela de SAMPLE_WINDOW_MS. O tom do buzzer é cancelado
+// do bloco, então a detecção continua durante a melodia sem que ela dispare a si mesma.
+static void sampling_task(void *ctx) {
+    apply_policy_changes();
+    if (!system_active) {
+        return;
+    }
+
+    float sound_level = measure_sound_level();
+
+    // Percentual de atividade nas duas janelas
+    uint8_t short_percent, activity_percent;
+    policy_window_push(&activity, sound_level > sound_threshold, &short_percent, &activity_percent);
+
+    // Atualização da tela: medidor (limiar na metade da barra) e histórico a cada segundo
+    static uint history_tick = 0;
+    ui_set_value(ui_level, (uint8_t)fminf(100.0f, sound_level * 50.0f / sound_threshold));
+    ui_set_text(ui_activity, "Atividade: %d%%", activity_percent);
+    if (++history_tick >= 1000 / SAMPLE_WINDOW_MS) {
+        history_tick = 0;
+        ui_push_sample(ui_history, activity_percent);
+    }
+
+    // Debug no terminal
+    printf("Nível: %.2f V | Atividade: %d%% (2 s) %d%% (10 s) | Nível de resposta: %d\n",
+          sound_level, short_percent, activity_percent, policy.level);
+
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    policy_action_t action = policy_update(&policy, short_percent, activity_percent, now_ms);
+    if (action.type == POLICY_ACTION_PLAY) {
+        const policy_tier_t *tier = action.tier;
+        printf("Resposta: %s (faixa %d, volume %d%%)\n", tier->name, tier->track, tier->volume);
+        melody_play(tier->track, tier->volume, tier->loop);
+        if (!night_in_episode) {
+            night_in_episode = true;
+            night_episode_start_ms = now_ms;
+        }
+        if (tier->notify) {
+            printf("Choro detectado!\n");
+            if (!cry_detected) {
+                night_cries++;
             }
+            cry_detected = true;
+            notify_push(NOTIFY_EVT_CRY, activity_percent, now_ms);
+            update_led_status(true, true);
+            ui_set_text(ui_headline, "Choro detectado!");
         }
+    } else if (action.type == POLICY_ACTION_FADE) {
+        printf("Silencio: encerrando a melodia\n");
+        melody_fade_out();
+        night_episode_end(now_ms);
+        cry_detected = false;
+        update_led_status(true, false);
+        ui_set_text(ui_headline, "Sistema ativado");
     }
 }
 
+// Mantém Wi-Fi ativo, envia notificações pendentes e o beacon de status
+static void network_task(void *ctx) {
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    notify_poll(now_ms);
+    http_server_poll();  // Corpo dos uploads e gravação na flash, fora do contexto do lwIP
+    ota_poll(now_ms);
+    discovery_update((system_active ? BEACON_FLAG_ACTIVE : 0) |
+                     (melody_is_playing() ? BEACON_FLAG_MELODY : 0) |
+                     (cry_detected ? BEACON_FLAG_CRY : 0),
+                     policy_window_long_pct(&activity), now_ms);
+    cyw43_arch_poll();
+}
+
+static void report_task(void *ctx) {
+    print_mem_report();
+}
+
+// Widgets das telas. Linha 0: barra de status comum; linha 7: mensagens (IP, alertas, calibração)
+static void setup_screens(void) {
+    ui_init();
+    ui_icon_wifi = ui_add_icon(UI_ALL_SCREENS, 0, 0);
+    ui_icon_mute = ui_add_icon(UI_ALL_SCREENS, 10, 0);
+    ui_icon_note = ui_add_icon(UI_ALL_SCREENS, 20, 0);
+    ui_icon_alert = ui_add_icon(UI_ALL_SCREENS, 30, 0);
+    ui_state = ui_add_label(UI_ALL_SCREENS, 48, 0);
+    ui_message = ui_add_label(UI_ALL_SCREENS, 0, 56);
+
+    ui_headline = ui_add_label(SCREEN_LIVE, 0, 16);
+    ui_level = ui_add_bar(SCREEN_LIVE, 0, 24, ssd1306_width, 8);
+    ui_activity = ui_add_label(SCREEN_LIVE, 0, 32);
+    ui_history = ui_add_sparkline(SCREEN_LIVE, 0, 40, ssd1306_width, 16);
+
+    ui_set_text(ui_add_label(SCREEN_SUMMARY, 0, 16), "Resumo da noite");
+    ui_night = ui_add_label(SCREEN_SUMMARY, 0, 24);
+    ui_cries = ui_add_label(SCREEN_SUMMARY, 0, 32);
+    ui_longest = ui_add_label(SCREEN_SUMMARY, 0, 40);
+    ui_melody = ui_add_label(SCREEN_SUMMARY, 0, 48);
+
+    ui_set_text(ui_state, "Aguardando");
+    ui_set_text(ui_headline, "Baba Eletronica");
+    ui_show(SCREEN_LIVE);
+}
+
+static uint64_t scheduler_clock(void) {
+    return time_us_64();
+}
+
 int main() {
+    mem_guard_init();
     stdio_init_all();
+    ota_init();
     adc_init();
     adc_gpio_init(MIC_PIN);
     adc_select_input(2); 
+    adc_fifo_setup(true, false, 0, false, false);
+    adc_set_clkdiv(48000000.0f / ADC_SAMPLE_RATE - 1);
 
     // Inicializa hardware
-    pwm_init_buzzer(BUZZER_PIN);
+    sched_init(&scheduler, scheduler_clock);
+    melody_init(BUZZER_PIN, &scheduler, NULL);
+    policy_init(&policy);
+    memcpy(policy_staged_tiers, policy.tiers, sizeof(policy_staged_tiers));
+    policy_staged_quiet_ms = policy.quiet_ms;
+    policy_staged_quiet_pct = policy.quiet_pct;
+    reset_detection();
+    auth_init(API_TOKEN);
     configure_leds();
     i2c_init(i2c1, ssd1306_i2c_clock * 1000);
     gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
@@ -218,28 +901,13 @@ int main() {
     gpio_pull_up(I2C_SCL);
     ssd1306_init();
 
-    // Botões
-    gpio_init(BUTTON_A_PIN);
-    gpio_set_dir(BUTTON_A_PIN, GPIO_IN);
-    gpio_pull_up(BUTTON_A_PIN);
-    gpio_init(BUTTON_B_PIN);
-    gpio_set_dir(BUTTON_B_PIN, GPIO_IN);
-    gpio_pull_up(BUTTON_B_PIN);
+    // Botões (interrupção + debounce por temporizador)
+    buttons_init(BUTTON_A_PIN, BUTTON_B_PIN);
 
     // Display
-    struct render_area frame_area = {
-        .start_column = 0,
-        .end_column = ssd1306_width - 1,
-        .start_page = 0,
-        .end_page = ssd1306_n_pages - 1
-    };
-    calculate_render_area_buffer_length(&frame_area);
-    uint8_t ssd[ssd1306_buffer_length];
-    memset(ssd, 0, ssd1306_buffer_length);
-    render_on_display(ssd, &frame_area);
-    ssd1306_draw_string(ssd, 0, 0, "Baba Eletronica");
-    ssd1306_draw_string(ssd, 0, 16, "Aguardando ativacao...");
-    render_on_display(ssd, &frame_area);
+    setup_screens();
+    ui_set_text(ui_message, "Conectando...");
+    ui_render(to_ms_since_boot(get_absolute_time()));
 
     // Wi-Fi
     if (cyw43_arch_init()) {
@@ -250,6 +918,7 @@ int main() {
     bool connected = false;
     while(connected == false){
         cyw43_arch_enable_sta_mode();
+        netif_set_hostname(&cyw43_state.netif[CYW43_ITF_STA], DEVICE_ID);
         printf("Conectando ao Wi-Fi...\n");
 
         if (cyw43_arch_wifi_connect_timeout_ms(WIFI_SSID, WIFI_PASS, CYW43_AUTH_WPA2_AES_PSK, 10000)){
@@ -266,97 +935,48 @@ int main() {
         (int)((cyw43_state.netif[0].ip_addr.addr >> 24) & 0xFF));
     
     printf("Wi-Fi conectado!\n");
-    start_http_server();
+    ui_set_text(ui_message, "%s", ip4addr_ntoa(netif_ip4_addr(&cyw43_state.netif[CYW43_ITF_STA])));
+    http_server_add_upload(&song_upload_route);
+    http_server_add_upload(&token_upload_route);
+    http_server_add_upload(&ota_upload_route);
+    if (!http_server_start(80, handle_http_request)) {
+        printf("Erro ao iniciar o webserver\n");
+    } else {
+        // Rede e webserver no ar: um firmware recém-atualizado confirma que está funcionando
+        ota_confirm();
+    }
 
-    // Loop principal
-    bool previous_state = system_active;
-    while (true) {
-        // Botões
-        if (gpio_get(BUTTON_A_PIN) == 0) {
-            system_active = true;
-            sleep_ms(200);
-        }
-        if (gpio_get(BUTTON_B_PIN) == 0) {
-            system_active = false;
-            melody_active = false;
-            cry_detected = false;
-            sleep_ms(200);
-        }
+    notify_config_t notify_config = {
+        .proto = NOTIFY_PROTO,
+        .host = NOTIFY_HOST,
+        .port = NOTIFY_PORT,
+        .path = NOTIFY_PATH,
+        .device_id = DEVICE_ID
+    };
+    if (!notify_init(&notify_config)) {
+        printf("Notificacoes desabilitadas\n");
+    }
+    discovery_init(DEVICE_ID, DEVICE_ROOM);
 
-        // Atualiza display se estado mudar
-        if (system_active != previous_state) {
-            update_led_status(system_active, false);
-            ssd1306_draw_string(ssd, 0, 16, system_active ? "Sistema ativado    " : "Sistema desativado ");
-            render_on_display(ssd, &frame_area);
-            previous_state = system_active;
-        }
+    // A partir daqui toda a memória vem de buffers estáticos
+    mem_guard_seal();
+    print_mem_report();
 
-        // Detecção de som
-        if (system_active) {
-            uint16_t raw_adc = adc_read();
-            float voltage = (raw_adc * ADC_REF) / ADC_RES;
-            float sound_level = fabs(voltage - SOUND_OFFSET);
-
-            if (system_active && !melody_active) {
-                static absolute_time_t last_sample;
-                
-                if (absolute_time_diff_us(last_sample, get_absolute_time()) >= SAMPLE_WINDOW_MS * 1000) {
-                    last_sample = get_absolute_time();
-                    
-                    // Leitura e processamento do ADC
-                    uint16_t raw_adc = adc_read();
-                    float voltage = (raw_adc * ADC_REF) / ADC_RES;
-                    float sound_level = fabs(voltage - SOUND_OFFSET);
-                    
-                    // Atualização do buffer circular
-                    uint32_t sample_value = (sound_level > SOUND_THRESHOLD) ? 1 : 0;
-                    
-                    // Subtrai a amostra mais antiga
-                    active_samples_count -= sample_buffer[sample_index];
-                    
-                    // Adiciona nova amostra
-                    sample_buffer[sample_index] = sample_value;
-                    active_samples_count += sample_value;
-                    
-                    // Atualiza índice circular
-                    sample_index = (sample_index + 1) % (DETECTION_DURATION_MS / SAMPLE_WINDOW_MS);
-                    
-                    // Cálculo do percentual de atividade
-                    float activity_percent = (active_samples_count * 100.0f) / (DETECTION_DURATION_MS / SAMPLE_WINDOW_MS);
-                    
-                    // Atualização do display
-                    char status[32];
-                    snprintf(status, sizeof(status), "Atividade: %d%%", (int)activity_percent);
-                    ssd1306_draw_string(ssd, 0, 32, status);
-                    render_on_display(ssd, &frame_area);
-                    
-                    // Debug no terminal
-                    printf("Nível: %.2f V | Amostras Ativas: %d/%d\n", 
-                          sound_level, active_samples_count, MIN_ACTIVE_SAMPLES);
-                    
-                    // Condição de disparo
-                    if (active_samples_count >= MIN_ACTIVE_SAMPLES) {
-                        printf("Choro detectado!\n");
-                        melody_active = true;
-                        cry_detected = true;
-                        update_led_status(true, true);
-                        ssd1306_draw_string(ssd, 0, 32, "Choro detectado!  ");
-                        render_on_display(ssd, &frame_area);
-                        play_melody(BUZZER_PIN);
-                        
-                        // Reset do buffer após detecção
-                        memset(sample_buffer, 0, sizeof(sample_buffer));
-                        active_samples_count = 0;
-                    }
-                }
-            }
-        }
+    // Cada atividade é uma tarefa com período e prioridade próprios
+    sched_add_periodic(&scheduler, "botoes", BUTTONS_PERIOD_MS, PRIORITY_BUTTONS, buttons_task, NULL);
+    sched_add_periodic(&scheduler, "amostragem", SAMPLE_WINDOW_MS, PRIORITY_SAMPLING, sampling_task, NULL);
+    sched_add_periodic(&scheduler, "estado", STATUS_PERIOD_MS, PRIORITY_STATUS, status_task, NULL);
+    sched_add_periodic(&scheduler, "rede", NETWORK_PERIOD_MS, PRIORITY_NETWORK, network_task, NULL);
+    sched_add_periodic(&scheduler, "tela", UI_FRAME_MS, PRIORITY_DISPLAY, display_task, NULL);
+    sched_add_periodic(&scheduler, "relatorio", MEM_REPORT_INTERVAL_MS, PRIORITY_REPORT, report_task, NULL);
 
-        // Mantém Wi-Fi ativo
-        cyw43_arch_poll();
-        sleep_ms(10);
+    // Loop principal: executa as tarefas prontas e dorme (WFE) até o próximo prazo
+    while (true) {
+        while (sched_run_next(&scheduler)) {
+        }
+        best_effort_wfe_or_timeout(from_us_since_boot(sched_next_deadline(&scheduler)));
     }
 
     cyw43_arch_deinit();
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,54 @@
+#include "pico/stdlib.h"
+#include "pico/bootrom.h"
+#include "hardware/watchdog.h"
+#include "hardware/structs/scb.h"
+#include "inc/flash_store.h"
+#include "inc/ota_image.h"
+
+// Bootloader: ocupa os primeiros OTA_BOOTLOADER_SIZE bytes da flash e sempre executa a
+// aplicação do slot A. Uma imagem nova recebida pela rede fica no slot B e só entra no
+// lugar da atual depois de conferida; se não confirmar a tempo, a troca é desfeita.
+
+static const uint8_t *boot_flash_read(uint32_t offset) {
+    return (const uint8_t *)(uintptr_t)(XIP_BASE + offset);
+}
+
+static const ota_flash_t boot_flash = {
+    .read = boot_flash_read,
+    .erase_program = flash_store_write_raw,
+    .program = flash_store_program_raw,
+    .control = FLASH_STORE_OFFSET + FLASH_STORE_OTA,
+    .journal = FLASH_STORE_OFFSET + FLASH_STORE_OTA_JOURNAL,
+    .scratch = FLASH_STORE_OFFSET + FLASH_STORE_OTA_SCRATCH
+};
+
+static ota_control_t control;
+
+static uint32_t boot_time_us(void) {
+    return time_us_32();
+}
+
+// Usa a tabela de vetores da aplicação e salta para o reset dela com a pilha inicial
+static void __attribute__((noreturn)) boot_application(void) {
+    const uint32_t *vectors = (const uint32_t *)(XIP_BASE + OTA_SLOT_A + OTA_VECTOR_OFFSET);
+    scb_hw->vtor = (uintptr_t)vectors;
+    __asm volatile (
+        "msr msp, %0\n"
+        "bx %1\n"
+        : : "r" (vectors[0]), "r" (vectors[1]));
+    __builtin_unreachable();
+}
+
+int main(void) {
+    // Troca, rollback e retomada após queda de energia ficam em inc/ota_image.c (testados no host)
+    bool trial = ota_boot(&boot_flash, &control, boot_time_us);
+
+    // Sem aplicação no slot A: espera uma gravação pelo USB
+    if (!ota_image_plausible(&boot_flash, OTA_SLOT_A, OTA_SLOT_SIZE)) {
+        reset_usb_boot(0, 0);
+    }
+    if (trial) {
+        watchdog_enable(OTA_WATCHDOG_MS, true);
+    }
+    boot_application();
+}
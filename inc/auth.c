@@ -0,0 +1,223 @@
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include "pico/stdlib.h"
+#include "pico/rand.h"
+#include "pico/cyw43_arch.h"
+#include "auth.h"
+#include "auth_hash.h"
+#include "flash_store.h"
+
+#define AUTH_MAGIC_0 'A'
+#define AUTH_MAGIC_1 'T'
+#define AUTH_VERSION 1
+#define AUTH_HEADER_MAX 128           // "Basic " + base64 de "usuario:token"
+
+// Registro gravado na flash: nunca guarda o token, só SHA-256(salt || token)
+typedef struct {
+    uint8_t magic[2];
+    uint8_t version;
+    uint8_t reserved;
+    uint8_t salt[AUTH_SALT_SIZE];
+    uint8_t hash[SHA256_DIGEST_SIZE];
+} auth_record_t;
+
+// Balde de fichas por IP: o crédito é guardado em ms (AUTH_RATE_REFILL_MS = uma requisição)
+typedef struct {
+    uint32_t ip;          // 0 = entrada livre
+    uint32_t credit_ms;
+    uint32_t last_ms;
+} auth_bucket_t;
+
+static auth_record_t record;
+static auth_bucket_t buckets[AUTH_RATE_ENTRIES];
+static uint32_t retry_after_s = 1;
+static bool using_default = false;
+
+static uint32_t checks = 0;
+static uint32_t denied = 0;
+static uint32_t limited = 0;
+static uint32_t hash_us_last = 0;
+static uint32_t hash_us_max = 0;
+
+void auth_init(const char *default_token) {
+    const auth_record_t *stored = (const auth_record_t *)flash_store_read(FLASH_STORE_AUTH);
+    if (stored->magic[0] == AUTH_MAGIC_0 && stored->magic[1] == AUTH_MAGIC_1 &&
+        stored->version == AUTH_VERSION) {
+        memcpy(&record, stored, sizeof(record));
+        using_default = false;
+        return;
+    }
+
+    // Sem token gravado: usa o padrão do firmware (só em RAM, a flash fica intacta)
+    memset(&record, 0, sizeof(record));
+    record.magic[0] = AUTH_MAGIC_0;
+    record.magic[1] = AUTH_MAGIC_1;
+    record.version = AUTH_VERSION;
+    auth_hash(record.salt, default_token, strlen(default_token), record.hash);
+    using_default = true;
+    printf("AVISO: token da API padrao em uso; rotas protegidas recusadas ate POST /auth/token\n");
+}
+
+bool auth_is_default(void) {
+    return using_default;
+}
+
+// Consome uma requisição do balde do IP; a entrada usada há mais tempo é reaproveitada
+static bool auth_take(uint32_t ip, uint32_t now_ms) {
+    const uint32_t capacity = AUTH_RATE_BURST * AUTH_RATE_REFILL_MS;
+    auth_bucket_t *bucket = NULL;
+    auth_bucket_t *oldest = &buckets[0];
+    for (int i = 0; i < AUTH_RATE_ENTRIES; i++) {
+        if (buckets[i].ip == ip && ip != 0) {
+            bucket = &buckets[i];
+            break;
+        }
+        if (buckets[i].ip == 0 || now_ms - buckets[i].last_ms > now_ms - oldest->last_ms) {
+            oldest = &buckets[i];
+        }
+    }
+    if (bucket == NULL) {
+        bucket = oldest;
+        bucket->ip = ip;
+        bucket->credit_ms = capacity;
+    } else {
+        uint32_t elapsed = now_ms - bucket->last_ms;
+        bucket->credit_ms = elapsed >= capacity - bucket->credit_ms ? capacity : bucket->credit_ms + elapsed;
+    }
+    bucket->last_ms = now_ms;
+
+    if (bucket->credit_ms < AUTH_RATE_REFILL_MS) {
+        retry_after_s = (AUTH_RATE_REFILL_MS - bucket->credit_ms + 999) / 1000;
+        return false;
+    }
+    bucket->credit_ms -= AUTH_RATE_REFILL_MS;
+    return true;
+}
+
+static int base64_value(char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+') return 62;
+    if (c == '/') return 63;
+    return -1;
+}
+
+// Decodifica base64 (para no '=' ou no primeiro caractere inválido); retorna o tamanho
+static uint32_t base64_decode(const char *in, uint8_t *out, uint32_t size) {
+    uint32_t len = 0;
+    uint32_t bits = 0;
+    int count = 0;
+    for (; *in != '\0'; in++) {
+        int value = base64_value(*in);
+        if (value < 0) {
+            break;
+        }
+        bits = (bits << 6) | value;
+        count += 6;
+        if (count >= 8) {
+            count -= 8;
+            if (len == size) {
+                break;
+            }
+            out[len++] = (bits >> count) & 0xFF;
+        }
+    }
+    return len;
+}
+
+auth_result_t auth_check(const http_request_t *request, uint32_t now_ms) {
+    checks++;
+    if (!auth_take(ip_addr_get_ip4_u32(&request->remote_ip), now_ms)) {
+        limited++;
+        return AUTH_LIMITED;
+    }
+
+    char header[AUTH_HEADER_MAX];
+    uint8_t decoded[AUTH_HEADER_MAX];
+    const char *token = NULL;
+    uint32_t len = 0;
+    if (http_request_header(request, "Authorization", header, sizeof(header))) {
+        if (strncasecmp(header, "Bearer ", 7) == 0) {
+            token = header + 7;
+            len = strlen(token);
+        } else if (strncasecmp(header, "Basic ", 6) == 0) {
+            // O navegador envia "usuario:senha"; o usuário é ignorado e a senha é o token
+            uint32_t decoded_len = base64_decode(header + 6, decoded, sizeof(decoded));
+            uint8_t *colon = memchr(decoded, ':', decoded_len);
+            if (colon != NULL) {
+                token = (const char *)colon + 1;
+                len = decoded_len - (colon + 1 - decoded);
+            }
+        }
+    }
+    if (token == NULL || len == 0 || len > AUTH_TOKEN_MAX) {
+        denied++;
+        return AUTH_DENIED;
+    }
+
+    uint32_t start = time_us_32();
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    auth_hash(record.salt, token, len, digest);
+    bool ok = auth_digest_equal(digest, record.hash);
+    hash_us_last = time_us_32() - start;
+    if (hash_us_last > hash_us_max) {
+        hash_us_max = hash_us_last;
+    }
+
+    if (!ok) {
+        denied++;
+        return AUTH_DENIED;
+    }
+    return AUTH_OK;
+}
+
+void auth_write_denied(http_response_t *response, auth_result_t result) {
+    if (result == AUTH_DEFAULT) {
+        http_response_printf(response, "HTTP/1.1 403 Forbidden\r\n"
+                                       "Content-Type: text/plain\r\n"
+                                       "Connection: close\r\n\r\n"
+                                       "Troque o token padrao com POST /auth/token\n");
+        return;
+    }
+    if (result == AUTH_LIMITED) {
+        http_response_printf(response, "HTTP/1.1 429 Too Many Requests\r\n"
+                                       "Retry-After: %lu\r\n"
+                                       "Connection: close\r\n\r\n",
+                             (unsigned long)retry_after_s);
+        return;
+    }
+    http_response_printf(response, "HTTP/1.1 401 Unauthorized\r\n"
+                                   "WWW-Authenticate: Basic realm=\"baba\"\r\n"
+                                   "Connection: close\r\n\r\n");
+}
+
+bool auth_set_token(const char *token, uint32_t len) {
+    if (len < AUTH_TOKEN_MIN || len > AUTH_TOKEN_MAX) {
+        return false;
+    }
+    auth_record_t updated = record;
+    for (int i = 0; i < AUTH_SALT_SIZE; i += 4) {
+        uint32_t value = get_rand_32();
+        memcpy(&updated.salt[i], &value, 4);
+    }
+    auth_hash(updated.salt, token, len, updated.hash);
+    if (!flash_store_write(FLASH_STORE_AUTH, (const uint8_t *)&updated, sizeof(updated))) {
+        return false;
+    }
+    // O auth_check lê salt e hash no IRQ do lwIP: a troca não pode ser vista pela metade
+    cyw43_arch_lwip_begin();
+    record = updated;
+    using_default = false;
+    cyw43_arch_lwip_end();
+    return true;
+}
+
+void auth_write_stats(http_response_t *response) {
+    http_response_printf(response, "{\"default_token\":%s,\"checks\":%lu,\"denied\":%lu,\"limited\":%lu,"
+                                   "\"hash_us\":%lu,\"hash_us_max\":%lu,\"budget_us\":%d}",
+                         using_default ? "true" : "false",
+                         (unsigned long)checks, (unsigned long)denied, (unsigned long)limited,
+                         (unsigned long)hash_us_last, (unsigned long)hash_us_max, AUTH_CHECK_BUDGET_US);
+}
@@ -0,0 +1,41 @@
+#ifndef auth_inc_h
+#define auth_inc_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "http_server.h"
+
+#define AUTH_TOKEN_MIN 8              // Tamanho mínimo de um novo token
+#define AUTH_TOKEN_MAX 64
+#define AUTH_RATE_ENTRIES 8           // IPs acompanhados pelo limitador (o menos recente é substituído)
+#define AUTH_RATE_BURST 5             // Requisições protegidas em sequência por IP
+#define AUTH_RATE_REFILL_MS 2000      // Tempo para recuperar uma requisição
+
+typedef enum {
+    AUTH_OK = 0,
+    AUTH_DENIED,    // Sem credencial ou token incorreto (401)
+    AUTH_LIMITED,   // Limite de requisições do IP esgotado (429)
+    AUTH_DEFAULT    // Token certo, mas ainda é o padrão do firmware: só a troca é aceita (403)
+} auth_result_t;
+
+// Carrega o hash do token gravado na flash; sem registro válido usa default_token
+extern void auth_init(const char *default_token);
+
+// true enquanto nenhum token foi gravado (o padrão do firmware é público)
+extern bool auth_is_default(void);
+
+// Verifica o token enviado como "Authorization: Bearer <token>" ou Basic (senha = token).
+// O token recebido é resumido com SHA-256 e comparado em tempo constante com o hash guardado.
+// Cada chamada consome uma requisição do balde do IP de origem.
+extern auth_result_t auth_check(const http_request_t *request, uint32_t now_ms);
+
+// Preenche a resposta 401 (com WWW-Authenticate), 429 (com Retry-After) ou 403 (token padrão)
+extern void auth_write_denied(http_response_t *response, auth_result_t result);
+
+// Troca o token e grava o novo hash na flash
+extern bool auth_set_token(const char *token, uint32_t len);
+
+// Contadores e custo do SHA-256 por verificação, em JSON
+extern void auth_write_stats(http_response_t *response);
+
+#endif
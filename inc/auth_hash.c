@@ -0,0 +1,18 @@
+#include "auth_hash.h"
+
+void auth_hash(const uint8_t salt[AUTH_SALT_SIZE], const char *token, uint32_t len,
+               uint8_t digest[SHA256_DIGEST_SIZE]) {
+    sha256_t ctx;
+    sha256_init(&ctx);
+    sha256_update(&ctx, salt, AUTH_SALT_SIZE);
+    sha256_update(&ctx, (const uint8_t *)token, len);
+    sha256_final(&ctx, digest);
+}
+
+bool auth_digest_equal(const uint8_t a[SHA256_DIGEST_SIZE], const uint8_t b[SHA256_DIGEST_SIZE]) {
+    uint8_t diff = 0;
+    for (int i = 0; i < SHA256_DIGEST_SIZE; i++) {
+        diff |= a[i] ^ b[i];
+    }
+    return diff == 0;
+}
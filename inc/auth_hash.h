@@ -0,0 +1,20 @@
+#ifndef auth_hash_inc_h
+#define auth_hash_inc_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sha256.h"
+
+#define AUTH_SALT_SIZE 16
+#define AUTH_CHECK_BUDGET_US 1000     // Custo máximo da verificação por requisição (roda no IRQ do lwIP)
+
+// Parte criptográfica do auth.c, sem dependência do hardware (medida no host em tests/test_auth_hash.c)
+
+// SHA-256(salt || token)
+extern void auth_hash(const uint8_t salt[AUTH_SALT_SIZE], const char *token, uint32_t len,
+                      uint8_t digest[SHA256_DIGEST_SIZE]);
+
+// Comparação sem saída antecipada: o tempo não depende de quantos bytes coincidem
+extern bool auth_digest_equal(const uint8_t a[SHA256_DIGEST_SIZE], const uint8_t b[SHA256_DIGEST_SIZE]);
+
+#endif
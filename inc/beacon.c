@@ -0,0 +1,47 @@
+#include <string.h>
+#include "beacon.h"
+
+size_t beacon_encode(const beacon_status_t *status, uint8_t *buffer, size_t size) {
+    size_t room_len = strnlen(status->room, BEACON_ROOM_MAX);
+    size_t len = BEACON_HEADER_SIZE + room_len;
+    if (size < len) {
+        return 0;
+    }
+
+    buffer[0] = 'B';
+    buffer[1] = 'E';
+    buffer[2] = BEACON_VERSION;
+    buffer[3] = status->flags;
+    buffer[4] = status->activity;
+    buffer[5] = 0;
+    buffer[6] = status->seq & 0xFF;
+    buffer[7] = status->seq >> 8;
+    buffer[8] = status->uptime_s & 0xFF;
+    buffer[9] = (status->uptime_s >> 8) & 0xFF;
+    buffer[10] = (status->uptime_s >> 16) & 0xFF;
+    buffer[11] = status->uptime_s >> 24;
+    buffer[12] = room_len;
+    memcpy(buffer + BEACON_HEADER_SIZE, status->room, room_len);
+    return len;
+}
+
+bool beacon_decode(const uint8_t *buffer, size_t size, beacon_status_t *status) {
+    if (size < BEACON_HEADER_SIZE || buffer[0] != 'B' || buffer[1] != 'E' ||
+        buffer[2] != BEACON_VERSION) {
+        return false;
+    }
+
+    size_t room_len = buffer[12];
+    if (room_len > BEACON_ROOM_MAX || size < BEACON_HEADER_SIZE + room_len) {
+        return false;
+    }
+
+    status->flags = buffer[3];
+    status->activity = buffer[4];
+    status->seq = buffer[6] | (buffer[7] << 8);
+    status->uptime_s = (uint32_t)buffer[8] | ((uint32_t)buffer[9] << 8) |
+                       ((uint32_t)buffer[10] << 16) | ((uint32_t)buffer[11] << 24);
+    memcpy(status->room, buffer + BEACON_HEADER_SIZE, room_len);
+    status->room[room_len] = '\0';
+    return true;
+}
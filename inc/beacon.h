@@ -0,0 +1,41 @@
+#ifndef beacon_inc_h
+#define beacon_inc_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Beacon UDP de status: cabeçalho fixo de 13 bytes + nome do cômodo
+//  0-1  magic 'B' 'E'
+//  2    versão do formato
+//  3    flags (bit0 sistema ativo, bit1 melodia tocando, bit2 choro detectado)
+//  4    atividade (%)
+//  5    reservado
+//  6-7  sequência (little-endian)
+//  8-11 uptime em segundos (little-endian)
+//  12   tamanho do nome do cômodo, seguido do nome (sem '\0')
+#define BEACON_PORT 4210
+#define BEACON_VERSION 1
+#define BEACON_HEADER_SIZE 13
+#define BEACON_ROOM_MAX 31
+#define BEACON_MAX_SIZE (BEACON_HEADER_SIZE + BEACON_ROOM_MAX)
+
+#define BEACON_FLAG_ACTIVE 0x01
+#define BEACON_FLAG_MELODY 0x02
+#define BEACON_FLAG_CRY    0x04
+
+typedef struct {
+    uint8_t flags;
+    uint8_t activity;
+    uint16_t seq;
+    uint32_t uptime_s;
+    char room[BEACON_ROOM_MAX + 1];
+} beacon_status_t;
+
+// Serializa o status; retorna o tamanho escrito ou 0 se não couber em buffer
+extern size_t beacon_encode(const beacon_status_t *status, uint8_t *buffer, size_t size);
+
+// Interpreta um pacote recebido; retorna false se o pacote for inválido
+extern bool beacon_decode(const uint8_t *buffer, size_t size, beacon_status_t *status);
+
+#endif
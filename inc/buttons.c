@@ -0,0 +1,82 @@
+#include "pico/stdlib.h"
+#include "buttons.h"
+
+static uint button_pins[BUTTON_COUNT];
+static bool button_pressed[BUTTON_COUNT];
+static alarm_id_t debounce_alarms[BUTTON_COUNT];
+static gesture_decoder_t decoder;
+static repeating_timer_t tick_timer;
+
+// Fila circular: produtores são as interrupções (mesma prioridade), consumidor é o loop principal
+static volatile gesture_t event_queue[BUTTON_QUEUE_SIZE];
+static volatile uint8_t queue_head = 0;
+static volatile uint8_t queue_tail = 0;
+
+static void queue_push(gesture_t gesture) {
+    if (gesture == GESTURE_NONE) {
+        return;
+    }
+    uint8_t next = (queue_head + 1) % BUTTON_QUEUE_SIZE;
+    if (next == queue_tail) {
+        return;  // Fila cheia: descarta o evento mais novo
+    }
+    event_queue[queue_head] = gesture;
+    queue_head = next;
+}
+
+bool buttons_get_event(gesture_t *gesture) {
+    if (queue_tail == queue_head) {
+        return false;
+    }
+    *gesture = event_queue[queue_tail];
+    queue_tail = (queue_tail + 1) % BUTTON_QUEUE_SIZE;
+    return true;
+}
+
+// Fim do período de debounce: o nível atual é o estado estável do botão
+static int64_t debounce_expired(alarm_id_t id, void *user_data) {
+    button_id_t button = (button_id_t)(uintptr_t)user_data;
+    debounce_alarms[button] = 0;
+
+    bool pressed = gpio_get(button_pins[button]) == 0;
+    if (pressed != button_pressed[button]) {
+        button_pressed[button] = pressed;
+        queue_push(gesture_edge(&decoder, button, pressed, to_ms_since_boot(get_absolute_time())));
+    }
+    return 0;
+}
+
+// Cada borda reinicia o temporizador de debounce do botão
+static void button_irq(uint gpio, uint32_t events) {
+    for (int i = 0; i < BUTTON_COUNT; i++) {
+        if (gpio == button_pins[i]) {
+            if (debounce_alarms[i] > 0) {
+                cancel_alarm(debounce_alarms[i]);
+            }
+            debounce_alarms[i] = add_alarm_in_ms(BUTTON_DEBOUNCE_MS, debounce_expired, (void *)(uintptr_t)i, true);
+        }
+    }
+}
+
+static bool gesture_timer(repeating_timer_t *timer) {
+    queue_push(gesture_tick(&decoder, to_ms_since_boot(get_absolute_time())));
+    return true;
+}
+
+void buttons_init(uint pin_a, uint pin_b) {
+    button_pins[BUTTON_A] = pin_a;
+    button_pins[BUTTON_B] = pin_b;
+    gesture_init(&decoder);
+
+    for (int i = 0; i < BUTTON_COUNT; i++) {
+        gpio_init(button_pins[i]);
+        gpio_set_dir(button_pins[i], GPIO_IN);
+        gpio_pull_up(button_pins[i]);
+        button_pressed[i] = false;
+        debounce_alarms[i] = 0;
+    }
+
+    gpio_set_irq_enabled_with_callback(pin_a, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true, button_irq);
+    gpio_set_irq_enabled(pin_b, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true);
+    add_repeating_timer_ms(BUTTON_TICK_MS, gesture_timer, NULL, &tick_timer);
+}
@@ -0,0 +1,18 @@
+#ifndef buttons_inc_h
+#define buttons_inc_h
+
+#include <stdbool.h>
+#include "pico/stdlib.h"
+#include "gesture.h"
+
+#define BUTTON_DEBOUNCE_MS 20   // Tempo de estabilização após a última borda
+#define BUTTON_TICK_MS 20       // Período de avaliação dos gestos temporizados
+#define BUTTON_QUEUE_SIZE 8     // Eventos aguardando o loop principal
+
+// Configura os botões (pull-up, ativos em nível baixo) com interrupção nas duas bordas
+extern void buttons_init(uint pin_a, uint pin_b);
+
+// Retira o próximo gesto da fila; retorna false se a fila estiver vazia
+extern bool buttons_get_event(gesture_t *gesture);
+
+#endif
@@ -0,0 +1,82 @@
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "lwip/init.h"
+#include "lwip/udp.h"
+#include "lwip/apps/mdns.h"
+#include "discovery.h"
+
+static struct udp_pcb *beacon_pcb = NULL;
+static beacon_status_t beacon_last;
+static uint32_t beacon_last_ms = 0;
+static bool beacon_sent_once = false;
+
+// Registro TXT do serviço HTTP
+static void http_service_txt(struct mdns_service *service, void *txt_userdata) {
+    const char *room = txt_userdata;
+    char txt[8 + BEACON_ROOM_MAX];
+    int len = snprintf(txt, sizeof(txt), "room=%s", room);
+    mdns_resp_add_service_txtitem(service, "path=/", 6);
+    mdns_resp_add_service_txtitem(service, txt, len);
+}
+
+bool discovery_init(const char *hostname, const char *room) {
+    struct netif *netif = &cyw43_state.netif[CYW43_ITF_STA];
+
+    memset(&beacon_last, 0, sizeof(beacon_last));
+    strncpy(beacon_last.room, room, BEACON_ROOM_MAX);
+
+    cyw43_arch_lwip_begin();
+    mdns_resp_init();
+#if LWIP_VERSION >= LWIP_MAKE_VERSION(2, 2, 0, 0)
+    mdns_resp_add_netif(netif, hostname);
+    mdns_resp_add_service(netif, hostname, "_http", DNSSD_PROTO_TCP, 80, http_service_txt, (void *)room);
+#else
+    mdns_resp_add_netif(netif, hostname, 60);
+    mdns_resp_add_service(netif, hostname, "_http", DNSSD_PROTO_TCP, 80, 60, http_service_txt, (void *)room);
+#endif
+    beacon_pcb = udp_new_ip_type(IPADDR_TYPE_V4);
+    cyw43_arch_lwip_end();
+
+    printf("mDNS: %s.local\n", hostname);
+    return beacon_pcb != NULL;
+}
+
+static void beacon_send(void) {
+    uint8_t packet[BEACON_MAX_SIZE];
+    size_t len = beacon_encode(&beacon_last, packet, sizeof(packet));
+
+    cyw43_arch_lwip_begin();
+    struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, len, PBUF_RAM);
+    if (p != NULL) {
+        pbuf_take(p, packet, len);
+        udp_sendto(beacon_pcb, p, IP_ADDR_BROADCAST, BEACON_PORT);
+        pbuf_free(p);
+    }
+    cyw43_arch_lwip_end();
+}
+
+void discovery_update(uint8_t flags, uint8_t activity, uint32_t now_ms) {
+    if (beacon_pcb == NULL) {
+        return;
+    }
+
+    uint32_t elapsed = now_ms - beacon_last_ms;
+    int activity_delta = (int)activity - (int)beacon_last.activity;
+    bool changed = flags != beacon_last.flags ||
+                   activity_delta >= BEACON_ACTIVITY_STEP || activity_delta <= -BEACON_ACTIVITY_STEP;
+
+    if (beacon_sent_once && elapsed < BEACON_PERIOD_MS && !(changed && elapsed >= BEACON_MIN_INTERVAL_MS)) {
+        return;
+    }
+
+    beacon_last.flags = flags;
+    beacon_last.activity = activity;
+    beacon_last.seq++;
+    beacon_last.uptime_s = now_ms / 1000;
+    beacon_send();
+
+    beacon_last_ms = now_ms;
+    beacon_sent_once = true;
+}
@@ -0,0 +1,18 @@
+#ifndef discovery_inc_h
+#define discovery_inc_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "beacon.h"
+
+#define BEACON_PERIOD_MS 5000        // Envio periódico mesmo sem mudanças
+#define BEACON_MIN_INTERVAL_MS 250   // Limite de envios quando o estado muda rápido
+#define BEACON_ACTIVITY_STEP 5       // Variação de atividade (%) que força um envio
+
+// Anuncia o dispositivo como <hostname>.local (serviço _http._tcp) e prepara o beacon
+extern bool discovery_init(const char *hostname, const char *room);
+
+// Envia o beacon se o estado mudou ou se o período expirou
+extern void discovery_update(uint8_t flags, uint8_t activity, uint32_t now_ms);
+
+#endif
@@ -0,0 +1,64 @@
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/flash.h"
+#include "hardware/flash.h"
+#include "flash_store.h"
+
+#define FLASH_STORE_TIMEOUT_MS 100
+
+typedef struct {
+    uint32_t offset;        // Deslocamento absoluto na flash
+    const uint8_t *data;
+    uint32_t len;
+    bool erase;
+} flash_store_op_t;
+
+// Última página parcial, completada com 0xFF (a gravação é sempre em páginas inteiras)
+static uint8_t flash_store_page[FLASH_PAGE_SIZE];
+
+const uint8_t *flash_store_read(uint32_t offset) {
+    return (const uint8_t *)(uintptr_t)(XIP_BASE + FLASH_STORE_OFFSET + offset);
+}
+
+// Executada com interrupções desligadas e sem acesso do XIP à flash
+static void flash_store_do_write(void *param) {
+    const flash_store_op_t *op = param;
+    uint32_t flash_offset = op->offset;
+    if (op->erase) {
+        uint32_t erase_len = (op->len + FLASH_SECTOR_SIZE - 1) & ~(FLASH_SECTOR_SIZE - 1);
+        flash_range_erase(flash_offset, erase_len);
+    }
+
+    uint32_t full_pages = op->len & ~(FLASH_PAGE_SIZE - 1);
+    if (full_pages > 0) {
+        flash_range_program(flash_offset, op->data, full_pages);
+    }
+    if (full_pages < op->len) {
+        memset(flash_store_page, 0xFF, sizeof(flash_store_page));
+        memcpy(flash_store_page, op->data + full_pages, op->len - full_pages);
+        flash_range_program(flash_offset + full_pages, flash_store_page, FLASH_PAGE_SIZE);
+    }
+}
+
+bool flash_store_write(uint32_t offset, const uint8_t *data, uint32_t len) {
+    if (offset + len > FLASH_STORE_SIZE) {
+        return false;
+    }
+    return flash_store_write_raw(FLASH_STORE_OFFSET + offset, data, len);
+}
+
+bool flash_store_write_raw(uint32_t flash_offset, const uint8_t *data, uint32_t len) {
+    if ((flash_offset & (FLASH_SECTOR_SIZE - 1)) != 0 || len == 0 || flash_offset + len > PICO_FLASH_SIZE_BYTES) {
+        return false;
+    }
+    flash_store_op_t op = { .offset = flash_offset, .data = data, .len = len, .erase = true };
+    return flash_safe_execute(flash_store_do_write, &op, FLASH_STORE_TIMEOUT_MS) == PICO_OK;
+}
+
+bool flash_store_program_raw(uint32_t flash_offset, const uint8_t *data, uint32_t len) {
+    if ((flash_offset & (FLASH_PAGE_SIZE - 1)) != 0 || len == 0 || flash_offset + len > PICO_FLASH_SIZE_BYTES) {
+        return false;
+    }
+    flash_store_op_t op = { .offset = flash_offset, .data = data, .len = len, .erase = false };
+    return flash_safe_execute(flash_store_do_write, &op, FLASH_STORE_TIMEOUT_MS) == PICO_OK;
+}
@@ -0,0 +1,36 @@
+#ifndef flash_store_inc_h
+#define flash_store_inc_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+
+// Região de dados no fim da flash, fora da área do programa
+#define FLASH_STORE_SIZE (64 * 1024)
+#define FLASH_STORE_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_STORE_SIZE)
+
+// Mapa da região (deslocamentos a partir de FLASH_STORE_OFFSET)
+#define FLASH_STORE_SONGS 0                                 // Faixas enviadas pela rede
+#define FLASH_STORE_SONG_SLOTS 4
+#define FLASH_STORE_SONG_SLOT_SIZE FLASH_SECTOR_SIZE        // 4 KB por faixa
+#define FLASH_STORE_AUTH (16 * 1024)                        // Hash do token da API (um setor)
+#define FLASH_STORE_OTA (20 * 1024)                         // Registro de controle da atualização
+#define FLASH_STORE_OTA_JOURNAL (24 * 1024)                 // Progresso da troca de slots
+#define FLASH_STORE_OTA_SCRATCH (28 * 1024)                 // Setor de rascunho da troca
+
+// Leitura direta pelo XIP, sem cópia para a RAM
+extern const uint8_t *flash_store_read(uint32_t offset);
+
+// Apaga os setores cobertos e grava os dados. offset deve estar alinhado a FLASH_SECTOR_SIZE.
+// data deve estar na RAM: as interrupções e o XIP ficam parados durante a operação
+// (flash_safe_execute).
+extern bool flash_store_write(uint32_t offset, const uint8_t *data, uint32_t len);
+
+// Como flash_store_write, mas com deslocamento absoluto (qualquer região, ex.: slots de firmware)
+extern bool flash_store_write_raw(uint32_t flash_offset, const uint8_t *data, uint32_t len);
+
+// Grava páginas sem apagar (só zera bits). flash_offset deve estar alinhado a FLASH_PAGE_SIZE.
+extern bool flash_store_program_raw(uint32_t flash_offset, const uint8_t *data, uint32_t len);
+
+#endif
@@ -0,0 +1,79 @@
+#include <string.h>
+#include "gesture.h"
+
+void gesture_init(gesture_decoder_t *decoder) {
+    memset(decoder, 0, sizeof(*decoder));
+}
+
+gesture_t gesture_edge(gesture_decoder_t *decoder, button_id_t button, bool pressed, uint32_t now_ms) {
+    if (pressed) {
+        decoder->down[button] = true;
+        decoder->down_since[button] = now_ms;
+        if (decoder->down[BUTTON_A] && decoder->down[BUTTON_B]) {
+            decoder->combo = true;
+            decoder->a_click_pending = false;
+        }
+        return GESTURE_NONE;
+    }
+
+    if (!decoder->down[button]) {
+        return GESTURE_NONE;
+    }
+    decoder->down[button] = false;
+
+    // Combinação A+B: nada é emitido até os dois botões serem soltos
+    if (decoder->combo) {
+        if (!decoder->down[BUTTON_A] && !decoder->down[BUTTON_B]) {
+            decoder->combo = false;
+            decoder->combo_fired = false;
+            decoder->long_fired = false;
+        }
+        return GESTURE_NONE;
+    }
+
+    if (button == BUTTON_B) {
+        if (decoder->long_fired) {
+            decoder->long_fired = false;
+            return GESTURE_NONE;
+        }
+        return GESTURE_B_CLICK;
+    }
+
+    if (decoder->a_click_pending && now_ms - decoder->a_last_click_ms <= GESTURE_DOUBLE_MS) {
+        decoder->a_click_pending = false;
+        return GESTURE_A_DOUBLE;
+    }
+    // O clique simples fica retido até a janela do duplo clique fechar (gesture_tick)
+    decoder->a_click_pending = true;
+    decoder->a_last_click_ms = now_ms;
+    return GESTURE_NONE;
+}
+
+gesture_t gesture_tick(gesture_decoder_t *decoder, uint32_t now_ms) {
+    if (decoder->combo) {
+        if (!decoder->combo_fired && decoder->down[BUTTON_A] && decoder->down[BUTTON_B]) {
+            // Conta a partir do último botão pressionado
+            uint32_t since = decoder->down_since[BUTTON_A];
+            if ((int32_t)(decoder->down_since[BUTTON_B] - since) > 0) {
+                since = decoder->down_since[BUTTON_B];
+            }
+            if (now_ms - since >= GESTURE_HOLD_BOTH_MS) {
+                decoder->combo_fired = true;
+                return GESTURE_AB_HOLD;
+            }
+        }
+        return GESTURE_NONE;
+    }
+
+    if (decoder->down[BUTTON_B] && !decoder->long_fired &&
+        now_ms - decoder->down_since[BUTTON_B] >= GESTURE_LONG_MS) {
+        decoder->long_fired = true;
+        return GESTURE_B_LONG;
+    }
+
+    if (decoder->a_click_pending && now_ms - decoder->a_last_click_ms > GESTURE_DOUBLE_MS) {
+        decoder->a_click_pending = false;
+        return GESTURE_A_CLICK;
+    }
+    return GESTURE_NONE;
+}
@@ -0,0 +1,45 @@
+#ifndef gesture_inc_h
+#define gesture_inc_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define GESTURE_DOUBLE_MS 400      // Intervalo máximo entre os cliques de um duplo clique
+#define GESTURE_LONG_MS 1500       // Tempo para um toque longo no botão B
+#define GESTURE_HOLD_BOTH_MS 2000  // Tempo segurando A e B juntos
+
+typedef enum {
+    BUTTON_A = 0,
+    BUTTON_B,
+    BUTTON_COUNT
+} button_id_t;
+
+typedef enum {
+    GESTURE_NONE = 0,
+    GESTURE_A_CLICK,    // A solto e nenhum segundo clique em GESTURE_DOUBLE_MS (emitido pelo tick)
+    GESTURE_A_DOUBLE,   // Segundo clique em A dentro de GESTURE_DOUBLE_MS (sem A_CLICK antes)
+    GESTURE_B_CLICK,    // Emitido ao soltar B antes de GESTURE_LONG_MS
+    GESTURE_B_LONG,     // B segurado por GESTURE_LONG_MS (o B_CLICK é suprimido)
+    GESTURE_AB_HOLD     // A e B segurados juntos (os cliques individuais são suprimidos)
+} gesture_t;
+
+// Decodificador puro: recebe bordas já sem bouncing e o tempo atual, sem acesso ao hardware
+typedef struct {
+    bool down[BUTTON_COUNT];
+    uint32_t down_since[BUTTON_COUNT];
+    bool long_fired;
+    bool combo;
+    bool combo_fired;
+    bool a_click_pending;
+    uint32_t a_last_click_ms;
+} gesture_decoder_t;
+
+extern void gesture_init(gesture_decoder_t *decoder);
+
+// Borda estável de um botão (pressed = true ao pressionar)
+extern gesture_t gesture_edge(gesture_decoder_t *decoder, button_id_t button, bool pressed, uint32_t now_ms);
+
+// Avaliação periódica dos gestos que dependem apenas do tempo (clique simples de A, toque longo, A+B)
+extern gesture_t gesture_tick(gesture_decoder_t *decoder, uint32_t now_ms);
+
+#endif
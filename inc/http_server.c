@@ -0,0 +1,568 @@
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "lwip/tcp.h"
+#include "lwip/memp.h"
+#include "lwip/stats.h"
+#include "http_server.h"
+
+#if HTTP_MAX_CLIENTS > LWIP_HTTP_CLIENTS
+#error "HTTP_MAX_CLIENTS excede o perfil de memoria do lwipopts.h"
+#endif
+#if HTTP_MAX_UPLOADS > LWIP_HTTP_UPLOADS
+#error "HTTP_MAX_UPLOADS excede o perfil de memoria do lwipopts.h"
+#endif
+
+#define HTTP_POLL_INTERVAL 2  // Ciclos do tcp_poll (~500 ms cada)
+
+// Estado de uma conexão. Os buffers ficam num pool estático: a resposta é entregue
+// ao lwIP sem cópia e só é liberada depois de confirmada pelo cliente.
+typedef struct {
+    struct tcp_pcb *pcb;
+    bool in_use;
+    bool responding;
+    uint8_t idle_polls;
+    uint16_t req_len;
+    uint16_t resp_len;
+    uint16_t resp_queued;
+    uint16_t resp_acked;
+    const http_upload_route_t *upload;  // Upload em andamento (corpo ainda chegando)
+    uint32_t body_remaining;
+    struct pbuf *body;          // Corpo aguardando o http_server_poll (janela ainda não devolvida)
+    uint16_t body_credit;       // Bytes da fila cuja janela já foi devolvida (chegaram com os cabeçalhos)
+    uint16_t head_body;         // Parte do corpo copiada em req junto com os cabeçalhos
+    uint16_t head_body_len;
+    bool fin;                   // Cliente encerrou o envio (FIN) durante o upload
+    http_request_t request;
+    char req[HTTP_REQUEST_MAX + 1];
+    char resp[HTTP_RESPONSE_MAX];
+} http_conn_t;
+
+static http_conn_t http_conns[HTTP_MAX_CLIENTS];
+static http_handler_fn http_handler = NULL;
+static const http_upload_route_t *http_uploads[HTTP_MAX_UPLOADS];
+static uint32_t http_rejected = 0;
+
+static const char HTTP_TOO_LARGE[] = "HTTP/1.1 431 Request Header Fields Too Large\r\nConnection: close\r\n\r\n";
+static const char HTTP_BAD_REQUEST[] = "HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n";
+static const char HTTP_LENGTH_REQUIRED[] = "HTTP/1.1 411 Length Required\r\nConnection: close\r\n\r\n";
+
+void http_response_printf(http_response_t *response, const char *format, ...) {
+    if (response->len >= response->size) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(response->buffer + response->len, response->size - response->len, format, args);
+    va_end(args);
+    if (len > 0) {
+        response->len += len;
+        if (response->len >= response->size) {
+            response->len = response->size - 1;
+        }
+    }
+}
+
+bool http_query_int(const char *query, const char *key, long *value) {
+    size_t key_len = strlen(key);
+    const char *param = query;
+    while (param != NULL && *param != '\0') {
+        if (strncmp(param, key, key_len) == 0 && param[key_len] == '=') {
+            const char *start = param + key_len + 1;
+            char *end;
+            long parsed = strtol(start, &end, 10);
+            if (end == start || (*end != '\0' && *end != '&')) {
+                return false;
+            }
+            *value = parsed;
+            return true;
+        }
+        param = strchr(param, '&');
+        if (param != NULL) {
+            param++;
+        }
+    }
+    return false;
+}
+
+bool http_request_header(const http_request_t *request, const char *name, char *value, size_t size) {
+    size_t name_len = strlen(name);
+    const char *line = request->headers;
+    while (line != NULL && strncmp(line, "\r\n", 2) != 0) {
+        const char *line_end = strstr(line, "\r\n");
+        if (line_end == NULL) {
+            break;
+        }
+        if (strncasecmp(line, name, name_len) == 0 && line[name_len] == ':') {
+            const char *start = line + name_len + 1;
+            while (*start == ' ' || *start == '\t') {
+                start++;
+            }
+            size_t len = line_end - start;
+            if (len >= size) {
+                return false;
+            }
+            memcpy(value, start, len);
+            value[len] = '\0';
+            return true;
+        }
+        line = line_end + 2;
+    }
+    return false;
+}
+
+// Solta o pcb. Com upload em andamento a posição só é liberada pelo http_server_poll, que
+// descarta a fila do corpo e avisa a rota (end com response NULL) fora do contexto do lwIP.
+static void http_conn_release(http_conn_t *conn) {
+    conn->pcb = NULL;
+    conn->in_use = conn->upload != NULL;
+}
+
+static err_t http_conn_close(http_conn_t *conn) {
+    struct tcp_pcb *pcb = conn->pcb;
+    http_conn_release(conn);
+    if (pcb == NULL) {
+        return ERR_OK;
+    }
+
+    tcp_arg(pcb, NULL);
+    tcp_recv(pcb, NULL);
+    tcp_sent(pcb, NULL);
+    tcp_err(pcb, NULL);
+    tcp_poll(pcb, NULL, 0);
+    if (tcp_close(pcb) != ERR_OK) {
+        tcp_abort(pcb);
+        return ERR_ABRT;
+    }
+    return ERR_OK;
+}
+
+// Descarta dados pendentes; usado quando a resposta (sem cópia) ainda não foi confirmada
+static err_t http_conn_abort(http_conn_t *conn) {
+    struct tcp_pcb *pcb = conn->pcb;
+    http_conn_release(conn);
+    if (pcb != NULL) {
+        tcp_arg(pcb, NULL);
+        tcp_err(pcb, NULL);
+        tcp_abort(pcb);
+    }
+    return ERR_ABRT;
+}
+
+// Enfileira o que couber no buffer de envio; o restante segue no tcp_sent
+static err_t http_conn_send(http_conn_t *conn) {
+    while (conn->resp_queued < conn->resp_len) {
+        uint16_t chunk = conn->resp_len - conn->resp_queued;
+        uint16_t space = tcp_sndbuf(conn->pcb);
+        if (space == 0) {
+            break;
+        }
+        if (chunk > space) {
+            chunk = space;
+        }
+        uint8_t flags = (conn->resp_queued + chunk < conn->resp_len) ? TCP_WRITE_FLAG_MORE : 0;
+        err_t err = tcp_write(conn->pcb, conn->resp + conn->resp_queued, chunk, flags);
+        if (err == ERR_MEM) {
+            break;  // Falta de segmentos: tenta de novo no próximo tcp_sent/tcp_poll
+        }
+        if (err != ERR_OK) {
+            return http_conn_abort(conn);
+        }
+        conn->resp_queued += chunk;
+    }
+    tcp_output(conn->pcb);
+    return ERR_OK;
+}
+
+static err_t http_conn_respond_static(http_conn_t *conn, const char *text) {
+    size_t len = strlen(text);
+    memcpy(conn->resp, text, len);
+    conn->resp_len = len;
+    conn->responding = true;
+    return http_conn_send(conn);
+}
+
+// Envia a resposta montada no buffer da conexão (vazia = apenas encerra)
+static err_t http_conn_respond(http_conn_t *conn, const http_response_t *response) {
+    if (response->len == 0) {
+        return http_conn_close(conn);
+    }
+    conn->resp_len = response->len;
+    conn->responding = true;
+    return http_conn_send(conn);
+}
+
+// Separa método, caminho e query da primeira linha da requisição. Só o caminho é copiado; a
+// query, como os cabeçalhos, aponta para req e é limitada apenas por HTTP_REQUEST_MAX.
+static bool http_parse_request(http_conn_t *conn) {
+    http_request_t *request = &conn->request;
+    char *line_end = strstr(conn->req, "\r\n");
+    char *method_end = memchr(conn->req, ' ', line_end - conn->req);
+    if (method_end == NULL || (size_t)(method_end - conn->req) >= sizeof(request->method)) {
+        return false;
+    }
+
+    char *target = method_end + 1;
+    char *target_end = memchr(target, ' ', line_end - target);
+    if (target_end == NULL) {
+        return false;
+    }
+    char *query = memchr(target, '?', target_end - target);
+    char *path_end = query != NULL ? query : target_end;
+    if ((size_t)(path_end - target) >= sizeof(request->path)) {
+        return false;
+    }
+
+    memcpy(request->method, conn->req, method_end - conn->req);
+    request->method[method_end - conn->req] = '\0';
+    memcpy(request->path, target, path_end - target);
+    request->path[path_end - target] = '\0';
+
+    if (query != NULL) {
+        *target_end = '\0';  // O espaço antes da versão HTTP termina a query dentro de req
+        request->query = query + 1;
+    } else {
+        request->query = request->path + strlen(request->path);
+    }
+    request->headers = line_end + 2;
+
+    char length[12];
+    request->content_length = 0;
+    if (http_request_header(request, "Content-Length", length, sizeof(length))) {
+        request->content_length = strtoul(length, NULL, 10);
+    }
+    ip_addr_copy(request->remote_ip, conn->pcb->remote_ip);
+    return true;
+}
+
+static const http_upload_route_t *http_find_upload(const char *path) {
+    for (int i = 0; i < HTTP_MAX_UPLOADS; i++) {
+        if (http_uploads[i] != NULL && strcmp(http_uploads[i]->path, path) == 0) {
+            return http_uploads[i];
+        }
+    }
+    return NULL;
+}
+
+static err_t http_conn_start_upload(http_conn_t *conn, const http_upload_route_t *route,
+                                    struct pbuf *p, uint16_t offset) {
+    if (conn->request.content_length == 0) {
+        return http_conn_respond_static(conn, HTTP_LENGTH_REQUIRED);
+    }
+    http_response_t response = {
+        .buffer = conn->resp,
+        .size = sizeof(conn->resp),
+        .len = 0
+    };
+    if (!route->begin(&conn->request, &response)) {
+        return http_conn_respond(conn, &response);
+    }
+    conn->body_remaining = conn->request.content_length;
+
+    // Parte do corpo que chegou junto com os cabeçalhos: a copiada em req e o restante do pbuf,
+    // que entra na fila (a janela de ambos já foi devolvida pelo http_recv)
+    // A busca parte do fim da linha de requisição, que pode ter o '\0' da query
+    char *body = strstr(conn->request.headers - 2, "\r\n\r\n") + 4;
+    conn->head_body = body - conn->req;
+    conn->head_body_len = conn->req_len - conn->head_body;
+    if (offset < p->tot_len) {
+        conn->body_credit = p->tot_len - offset;
+        pbuf_ref(p);
+        conn->body = pbuf_free_header(p, offset);
+    }
+    conn->upload = route;
+    return ERR_OK;
+}
+
+static err_t http_conn_process(http_conn_t *conn, struct pbuf *p) {
+    if (conn->responding) {
+        return ERR_OK;
+    }
+
+    // Copia percorrendo toda a cadeia de pbufs, sem assumir terminação em '\0'
+    uint16_t space = HTTP_REQUEST_MAX - conn->req_len;
+    uint16_t copy = p->tot_len < space ? p->tot_len : space;
+    pbuf_copy_partial(p, conn->req + conn->req_len, copy, 0);
+    conn->req_len += copy;
+    conn->req[conn->req_len] = '\0';
+
+    if (strstr(conn->req, "\r\n\r\n") == NULL) {
+        if (conn->req_len == HTTP_REQUEST_MAX) {
+            return http_conn_respond_static(conn, HTTP_TOO_LARGE);
+        }
+        return ERR_OK;  // Aguarda o restante dos cabeçalhos
+    }
+
+    if (!http_parse_request(conn)) {
+        return http_conn_respond_static(conn, HTTP_BAD_REQUEST);
+    }
+
+    const http_upload_route_t *route = http_find_upload(conn->request.path);
+    if (route != NULL && strcmp(conn->request.method, "POST") == 0) {
+        return http_conn_start_upload(conn, route, p, copy);
+    }
+
+    http_response_t response = {
+        .buffer = conn->resp,
+        .size = sizeof(conn->resp),
+        .len = 0
+    };
+    http_handler(&conn->request, &response);
+    return http_conn_respond(conn, &response);
+}
+
+static err_t http_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
+    http_conn_t *conn = arg;
+    if (p == NULL) {
+        // Cliente encerrou o envio; a resposta em andamento termina no tcp_sent
+        if (conn->responding && conn->resp_acked < conn->resp_len) {
+            return ERR_OK;
+        }
+        // Durante um upload o FIN é só o fim da entrada: a fila ainda vai para a rota e a
+        // resposta sai antes do fechamento (o http_server_poll fecha se o corpo veio incompleto)
+        if (conn->upload != NULL) {
+            conn->fin = true;
+            return ERR_OK;
+        }
+        return http_conn_close(conn);
+    }
+    if (err != ERR_OK) {
+        pbuf_free(p);
+        return ERR_OK;
+    }
+
+    conn->idle_polls = 0;
+
+    // Corpo de upload: fica na fila até o http_server_poll entregá-lo à rota, que devolve
+    // a janela à medida que consome
+    if (conn->upload != NULL) {
+        if (conn->body == NULL) {
+            conn->body = p;
+        } else {
+            pbuf_cat(conn->body, p);
+        }
+        return ERR_OK;
+    }
+
+    // Devolve a janela de recepção pelo total recebido (antes de um possível tcp_close)
+    tcp_recved(tpcb, p->tot_len);
+    err_t result = http_conn_process(conn, p);
+    pbuf_free(p);
+    return result;
+}
+
+static err_t http_sent(void *arg, struct tcp_pcb *tpcb, uint16_t len) {
+    http_conn_t *conn = arg;
+    conn->resp_acked += len;
+    conn->idle_polls = 0;
+    if (conn->resp_acked >= conn->resp_len) {
+        return http_conn_close(conn);
+    }
+    return http_conn_send(conn);
+}
+
+static err_t http_poll(void *arg, struct tcp_pcb *tpcb) {
+    http_conn_t *conn = arg;
+    if (conn->upload != NULL && (conn->body != NULL || conn->head_body_len > 0)) {
+        conn->idle_polls = 0;  // Quem está atrasado é o servidor (gravando), não o cliente
+    }
+    if (++conn->idle_polls > HTTP_IDLE_TIMEOUT_S * 2 / HTTP_POLL_INTERVAL) {
+        return http_conn_abort(conn);
+    }
+    if (conn->responding) {
+        return http_conn_send(conn);
+    }
+    return ERR_OK;
+}
+
+static void http_err(void *arg, err_t err) {
+    // O pcb já foi liberado pelo lwIP
+    http_conn_t *conn = arg;
+    if (conn != NULL) {
+        http_conn_release(conn);
+    }
+}
+
+static err_t http_accept(void *arg, struct tcp_pcb *newpcb, err_t err) {
+    if (err != ERR_OK || newpcb == NULL) {
+        return ERR_VAL;
+    }
+
+    http_conn_t *conn = NULL;
+    for (int i = 0; i < HTTP_MAX_CLIENTS; i++) {
+        if (!http_conns[i].in_use) {
+            conn = &http_conns[i];
+            break;
+        }
+    }
+    if (conn == NULL) {
+        http_rejected++;
+        tcp_abort(newpcb);
+        return ERR_ABRT;
+    }
+
+    memset(conn, 0, offsetof(http_conn_t, req));
+    conn->in_use = true;
+    conn->pcb = newpcb;
+    conn->req[0] = '\0';
+
+    tcp_arg(newpcb, conn);
+    tcp_recv(newpcb, http_recv);
+    tcp_sent(newpcb, http_sent);
+    tcp_err(newpcb, http_err);
+    tcp_poll(newpcb, http_poll, HTTP_POLL_INTERVAL);
+    return ERR_OK;
+}
+
+// Libera o primeiro pbuf da fila do corpo (com a trava do lwIP)
+static void http_conn_drop_body_head(http_conn_t *conn) {
+    struct pbuf *head = conn->body;
+    conn->body = head->next;
+    head->next = NULL;
+    pbuf_free(head);
+}
+
+// Entrega à rota até HTTP_UPLOAD_POLL_BYTES do corpo e, no fim, envia a resposta do end.
+// Roda fora do contexto do lwIP: a trava só é tomada para mexer na fila e no pcb, nunca
+// durante write/end, que podem parar as interrupções gravando a flash.
+static void http_conn_poll_upload(http_conn_t *conn) {
+    const http_upload_route_t *route = conn->upload;
+    bool ok = true;
+    uint32_t delivered = 0;
+
+    // req não muda durante o upload: o corpo que chegou com os cabeçalhos é lido sem a trava
+    if (conn->head_body_len > 0) {
+        uint32_t len = conn->head_body_len < conn->body_remaining ? conn->head_body_len : conn->body_remaining;
+        conn->head_body_len = 0;
+        conn->body_remaining -= len;
+        delivered = len;
+        ok = len == 0 || route->write((const uint8_t *)conn->req + conn->head_body, len);
+    }
+
+    bool lost = false;
+    while (ok && conn->body_remaining > 0 && delivered < HTTP_UPLOAD_POLL_BYTES) {
+        cyw43_arch_lwip_begin();
+        struct pbuf *head = conn->body;
+        lost = conn->pcb == NULL;
+        cyw43_arch_lwip_end();
+        if (head == NULL || lost) {
+            break;
+        }
+
+        // Só esta função libera o pbuf da frente; o lwIP apenas acrescenta ao fim da fila
+        uint16_t len = head->len;
+        uint32_t used = len < conn->body_remaining ? len : conn->body_remaining;
+        conn->body_remaining -= used;
+        delivered += len;
+        ok = used == 0 || route->write(head->payload, used);
+
+        cyw43_arch_lwip_begin();
+        http_conn_drop_body_head(conn);
+        uint16_t credit = conn->body_credit < len ? conn->body_credit : len;
+        conn->body_credit -= credit;
+        if (conn->pcb != NULL && len > credit) {
+            tcp_recved(conn->pcb, len - credit);
+        }
+        cyw43_arch_lwip_end();
+    }
+
+    cyw43_arch_lwip_begin();
+    lost = conn->pcb == NULL;
+    bool truncated = conn->fin && conn->body == NULL && conn->body_remaining > 0;
+    cyw43_arch_lwip_end();
+    if (!lost && !truncated && ok && conn->body_remaining > 0) {
+        return;  // Aguarda mais dados
+    }
+    // Conexão perdida ou FIN antes do Content-Length: a rota descarta o upload
+    bool discard = lost || (ok && truncated);
+
+    http_response_t response = {
+        .buffer = conn->resp,
+        .size = sizeof(conn->resp),
+        .len = 0
+    };
+    route->end(&conn->request, discard ? NULL : &response);
+
+    cyw43_arch_lwip_begin();
+    while (conn->body != NULL) {
+        http_conn_drop_body_head(conn);  // Bytes além do Content-Length ou após uma recusa
+    }
+    conn->upload = NULL;
+    if (conn->pcb != NULL && discard) {
+        http_conn_close(conn);
+    } else if (conn->pcb != NULL) {
+        http_conn_respond(conn, &response);
+    } else {
+        conn->in_use = false;
+    }
+    cyw43_arch_lwip_end();
+}
+
+void http_server_poll(void) {
+    for (int i = 0; i < HTTP_MAX_CLIENTS; i++) {
+        http_conn_t *conn = &http_conns[i];
+        cyw43_arch_lwip_begin();
+        bool uploading = conn->in_use && conn->upload != NULL;
+        cyw43_arch_lwip_end();
+        if (uploading) {
+            http_conn_poll_upload(conn);
+        }
+    }
+}
+
+bool http_server_add_upload(const http_upload_route_t *route) {
+    for (int i = 0; i < HTTP_MAX_UPLOADS; i++) {
+        if (http_uploads[i] == NULL) {
+            http_uploads[i] = route;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool http_server_start(uint16_t port, http_handler_fn handler) {
+    http_handler = handler;
+    bool started = false;
+
+    cyw43_arch_lwip_begin();
+    struct tcp_pcb *pcb = tcp_new_ip_type(IPADDR_TYPE_V4);
+    if (pcb != NULL && tcp_bind(pcb, IP_ADDR_ANY, port) == ERR_OK) {
+        struct tcp_pcb *listen_pcb = tcp_listen_with_backlog(pcb, HTTP_MAX_CLIENTS);
+        if (listen_pcb != NULL) {
+            tcp_accept(listen_pcb, http_accept);
+            started = true;
+        }
+    }
+    if (!started && pcb != NULL) {
+        tcp_close(pcb);
+    }
+    cyw43_arch_lwip_end();
+    return started;
+}
+
+void http_server_write_stats(http_response_t *response) {
+    http_response_printf(response, "{\"http_rejected\":%lu", (unsigned long)http_rejected);
+#if LWIP_STATS && MEM_STATS
+    http_response_printf(response, ",\"mem\":{\"avail\":%u,\"used\":%u,\"max\":%u,\"err\":%u}",
+        (unsigned)lwip_stats.mem.avail, (unsigned)lwip_stats.mem.used,
+        (unsigned)lwip_stats.mem.max, (unsigned)lwip_stats.mem.err);
+#endif
+#if LWIP_STATS && MEMP_STATS
+    http_response_printf(response, ",\"memp\":[");
+    for (int i = 0; i < MEMP_MAX; i++) {
+        const struct stats_mem *pool = lwip_stats.memp[i];
+        http_response_printf(response, "%s{", i ? "," : "");
+#if defined(LWIP_DEBUG) || LWIP_STATS_DISPLAY
+        http_response_printf(response, "\"name\":\"%s\",", pool->name);
+#endif
+        http_response_printf(response, "\"avail\":%u,\"used\":%u,\"max\":%u,\"err\":%u}",
+            (unsigned)pool->avail, (unsigned)pool->used, (unsigned)pool->max, (unsigned)pool->err);
+    }
+    http_response_printf(response, "]");
+#endif
+    http_response_printf(response, "}");
+}
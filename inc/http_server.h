@@ -0,0 +1,71 @@
+#ifndef http_server_inc_h
+#define http_server_inc_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "lwip/ip_addr.h"
+
+#define HTTP_MAX_CLIENTS 4            // Conexões simultâneas atendidas (ver lwipopts.h)
+#define HTTP_REQUEST_MAX 512          // Tamanho máximo da linha de requisição + cabeçalhos
+#define HTTP_RESPONSE_MAX 2048        // Tamanho máximo de uma resposta
+#define HTTP_IDLE_TIMEOUT_S 5         // Conexões sem progresso são encerradas
+#define HTTP_MAX_UPLOADS 3            // Rotas que recebem corpo (POST)
+#define HTTP_UPLOAD_POLL_BYTES 4096   // Corpo entregue por conexão a cada http_server_poll
+
+typedef struct {
+    char method[8];
+    char path[64];          // Caminho até o '?' (mais longo: 400 Bad Request)
+    const char *query;      // Texto após '?' (vazio se não houver), sem limite próprio além de HTTP_REQUEST_MAX
+    const char *headers;    // Linhas de cabeçalho, terminadas por "\r\n\r\n"
+    uint32_t content_length;  // Tamanho do corpo (0 se não informado)
+    ip_addr_t remote_ip;
+} http_request_t;
+
+typedef struct {
+    char *buffer;
+    size_t size;
+    size_t len;
+} http_response_t;
+
+// Preenche a resposta completa (linha de status, cabeçalhos e corpo)
+typedef void (*http_handler_fn)(const http_request_t *request, http_response_t *response);
+
+// Rota POST que recebe o corpo em partes, à medida que chega, sem guardá-lo inteiro em RAM.
+// O begin roda no contexto do lwIP e deve ser rápido; write e end rodam em http_server_poll,
+// fora dele, e podem gravar a flash. A janela TCP só é devolvida depois que write consome os
+// dados, então um cliente rápido espera pela gravação em vez de esgotar os pbufs.
+typedef struct {
+    const char *path;
+    // Cabeçalhos recebidos: retorna false e preenche a resposta para recusar o envio
+    bool (*begin)(const http_request_t *request, http_response_t *response);
+    // Próxima parte do corpo: retorna false para interromper (a resposta sai pelo end)
+    bool (*write)(const uint8_t *data, uint16_t len);
+    // Fim do corpo ou falha na escrita: preenche a resposta. Com response NULL a conexão
+    // caiu ou o cliente encerrou o envio antes do Content-Length, e o upload deve ser descartado.
+    // Um FIN depois do corpo completo não descarta nada: a resposta é enviada antes de fechar.
+    void (*end)(const http_request_t *request, http_response_t *response);
+} http_upload_route_t;
+
+extern bool http_server_start(uint16_t port, http_handler_fn handler);
+
+// Registra uma rota de upload (antes de http_server_start)
+extern bool http_server_add_upload(const http_upload_route_t *route);
+
+// Entrega às rotas de upload o corpo recebido (até HTTP_UPLOAD_POLL_BYTES por conexão) e
+// envia a resposta do end; chamada periodicamente pelo loop principal
+extern void http_server_poll(void);
+
+// Copia o valor de um cabeçalho (nome sem diferenciar maiúsculas); false se ausente
+extern bool http_request_header(const http_request_t *request, const char *name, char *value, size_t size);
+
+// Acrescenta texto formatado à resposta (trunca se exceder HTTP_RESPONSE_MAX)
+extern void http_response_printf(http_response_t *response, const char *format, ...);
+
+// Lê um parâmetro inteiro da query string (ex.: "volume=80&loop=1"); false se ausente ou inválido
+extern bool http_query_int(const char *query, const char *key, long *value);
+
+// Escreve em JSON o uso dos pools de memória do lwIP (inclui contadores de esgotamento)
+extern void http_server_write_stats(http_response_t *response);
+
+#endif
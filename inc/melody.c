@@ -0,0 +1,140 @@
+#include "pico/stdlib.h"
+#include "hardware/pwm.h"
+#include "hardware/clocks.h"
+#include "melody.h"
+#include "song.h"
+
+static uint buzzer_pin;
+static scheduler_t *melody_sched;
+static melody_stopped_fn stopped_callback;
+
+static volatile bool playing = false;
+static volatile uint current_frequency = 0;
+static bool sequence_running = false;
+static bool in_gap = false;
+static uint note_index = 0;
+static const uint8_t *track = NULL;      // Faixa no formato compacto, lida direto da flash
+static uint repeats_left = 0;
+static bool looping = true;
+static bool fading = false;
+static uint8_t volume = MELODY_VOLUME_MAX;
+
+// Ajusta o PWM para a frequência indicada (0 desliga o som). O volume controla o duty cycle:
+// MELODY_VOLUME_MAX corresponde a 50%.
+static void set_tone(uint frequency, uint8_t level) {
+    if (frequency == 0 || level == 0) {
+        pwm_set_gpio_level(buzzer_pin, 0);
+        current_frequency = 0;
+        return;
+    }
+
+    uint slice_num = pwm_gpio_to_slice_num(buzzer_pin);
+    uint32_t top = (uint32_t)(clock_get_hz(clk_sys) / MELODY_PWM_CLKDIV) / frequency - 1;
+    if (top > 0xFFFF) {
+        top = 0xFFFF;  // song_validate já recusa notas tão graves; evita truncar o contador
+    }
+    pwm_set_wrap(slice_num, top);
+    pwm_set_gpio_level(buzzer_pin, top * level / (2 * MELODY_VOLUME_MAX));
+    current_frequency = frequency;
+}
+
+// Tarefa do sequenciador: alterna entre nota e pausa, reagendando-se a cada passo
+static void melody_step(void *ctx) {
+    if (!playing) {
+        set_tone(0, 0);
+        sequence_running = false;
+        if (stopped_callback) {
+            stopped_callback();
+        }
+        return;
+    }
+
+    if (!in_gap) {
+        set_tone(0, 0);
+        in_gap = true;
+        sched_add_oneshot(melody_sched, "melodia", MELODY_GAP_MS, MELODY_PRIORITY, melody_step, NULL);
+        return;
+    }
+
+    if (fading) {
+        volume = volume > MELODY_FADE_STEP ? volume - MELODY_FADE_STEP : 0;
+    }
+    if (note_index >= song_note_count(track)) {
+        note_index = 0;
+        if (!looping && --repeats_left == 0) {
+            playing = false;
+        }
+    }
+    if (!playing || volume == 0) {
+        playing = false;
+        sched_add_oneshot(melody_sched, "melodia", 0, MELODY_PRIORITY, melody_step, NULL);
+        return;
+    }
+
+    song_note_t note;
+    song_get_note(track, note_index, &note);
+    set_tone(note.frequency, volume * note.volume / 100);
+    in_gap = false;
+    sched_add_oneshot(melody_sched, "melodia", note.duration_ms, MELODY_PRIORITY, melody_step, NULL);
+    note_index++;
+}
+
+void melody_init(uint pin, scheduler_t *sched, melody_stopped_fn on_stopped) {
+    buzzer_pin = pin;
+    melody_sched = sched;
+    stopped_callback = on_stopped;
+
+    gpio_set_function(pin, GPIO_FUNC_PWM);
+    uint slice_num = pwm_gpio_to_slice_num(pin);
+    pwm_config config = pwm_get_default_config();
+    pwm_config_set_clkdiv(&config, MELODY_PWM_CLKDIV);
+    pwm_init(slice_num, &config, true);
+    pwm_set_gpio_level(pin, 0);
+}
+
+bool melody_play(uint index, uint8_t level, bool loop) {
+    const uint8_t *song = song_library_get(index);
+    if (song == NULL) {
+        return false;
+    }
+    if (song != track || !playing) {
+        track = song;
+        note_index = 0;
+        repeats_left = song_repeats(song) ? song_repeats(song) : 1;
+    }
+    looping = loop;
+    fading = false;
+    melody_set_volume(level);
+    playing = true;
+    if (!sequence_running) {
+        sequence_running = true;
+        in_gap = true;
+        sched_add_oneshot(melody_sched, "melodia", 0, MELODY_PRIORITY, melody_step, NULL);
+    }
+    return true;
+}
+
+void melody_set_volume(uint8_t level) {
+    volume = level > MELODY_VOLUME_MAX ? MELODY_VOLUME_MAX : level;
+}
+
+void melody_fade_out(void) {
+    if (playing) {
+        fading = true;
+    }
+}
+
+void melody_request_stop(void) {
+    playing = false;
+    fading = false;
+    pwm_set_gpio_level(buzzer_pin, 0);
+    current_frequency = 0;
+}
+
+bool melody_is_playing(void) {
+    return playing;
+}
+
+uint melody_current_frequency(void) {
+    return current_frequency;
+}
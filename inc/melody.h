@@ -0,0 +1,39 @@
+#ifndef melody_inc_h
+#define melody_inc_h
+
+#include <stdbool.h>
+#include "pico/stdlib.h"
+#include "scheduler.h"
+
+#define MELODY_PWM_CLKDIV 64.0f   // 125 MHz / 64: notas de 31 Hz a 5 kHz cabem no contador de 16 bits
+#define MELODY_GAP_MS 30          // Pausa entre notas
+#define MELODY_PRIORITY 4         // Prioridade da tarefa do sequenciador
+#define MELODY_VOLUME_MAX 100     // Volume 100 = duty de 50%
+#define MELODY_FADE_STEP 10       // Redução de volume por nota durante o fade-out
+
+typedef void (*melody_stopped_fn)(void);
+
+// Configura o PWM do buzzer; on_stopped é chamada (pelo escalonador) quando a melodia termina
+extern void melody_init(uint pin, scheduler_t *sched, melody_stopped_fn on_stopped);
+
+// Toca a faixa indicada da biblioteca (song_library_get), em loop ou pelo número de repetições
+// da faixa. As notas são decodificadas direto da flash e avançam por tarefas únicas do
+// escalonador, sem bloquear. Se já houver uma faixa tocando, a troca acontece na próxima nota.
+// Retorna false se a faixa não existir.
+extern bool melody_play(uint track, uint8_t volume, bool loop);
+
+// Altera o volume (0 a MELODY_VOLUME_MAX) a partir da próxima nota
+extern void melody_set_volume(uint8_t volume);
+
+// Reduz o volume a cada nota e para ao chegar a zero
+extern void melody_fade_out(void);
+
+// Pode ser chamada de interrupções/callbacks do lwIP: silencia o buzzer imediatamente
+extern void melody_request_stop(void);
+
+extern bool melody_is_playing(void);
+
+// Frequência sendo emitida agora (0 = silêncio)
+extern uint melody_current_frequency(void);
+
+#endif
@@ -0,0 +1,62 @@
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "mem_guard.h"
+
+#define MEM_GUARD_PAINT_MARGIN 256  // Bytes preservados abaixo do quadro atual ao pintar
+
+// Limites das pilhas definidos pelo linker script do SDK
+extern uint32_t __StackBottom[], __StackTop[];
+extern uint32_t __StackOneBottom[], __StackOneTop[];
+
+struct _reent;
+
+static volatile bool heap_sealed = false;
+static volatile uint32_t heap_ops_after_boot = 0;
+
+void mem_guard_init(void) {
+    uint32_t marker;
+
+    // Núcleo 0: pinta do fundo até um pouco abaixo do quadro em uso
+    uint32_t *limit = (uint32_t *)(((uintptr_t)&marker - MEM_GUARD_PAINT_MARGIN) & ~3u);
+    for (uint32_t *p = __StackBottom; p < limit; p++) {
+        *p = MEM_GUARD_STACK_FILL;
+    }
+
+    // Núcleo 1: pilha ainda não está em uso
+    for (uint32_t *p = __StackOneBottom; p < __StackOneTop; p++) {
+        *p = MEM_GUARD_STACK_FILL;
+    }
+}
+
+void mem_guard_seal(void) {
+    heap_sealed = true;
+}
+
+void mem_guard_stack_usage(uint core, uint32_t *used, uint32_t *size) {
+    const uint32_t *bottom = core ? __StackOneBottom : __StackBottom;
+    const uint32_t *top = core ? __StackOneTop : __StackTop;
+    const uint32_t *p = bottom;
+
+    while (p < top && *p == MEM_GUARD_STACK_FILL) {
+        p++;
+    }
+    *used = (top - p) * sizeof(uint32_t);
+    *size = (top - bottom) * sizeof(uint32_t);
+}
+
+uint32_t mem_guard_heap_ops_after_boot(void) {
+    return heap_ops_after_boot;
+}
+
+// O malloc/free da newlib chama estes ganchos em toda operação de heap
+void __malloc_lock(struct _reent *reent) {
+    if (heap_sealed) {
+        heap_ops_after_boot++;
+#if BABA_TRAP_HEAP
+        panic("Uso do heap apos a inicializacao");
+#endif
+    }
+}
+
+void __malloc_unlock(struct _reent *reent) {
+}
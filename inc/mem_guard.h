@@ -0,0 +1,23 @@
+#ifndef mem_guard_inc_h
+#define mem_guard_inc_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pico/stdlib.h"
+
+#define MEM_GUARD_STACK_FILL 0xA5A5A5A5u  // Padrão usado para medir o uso máximo das pilhas
+
+// Pinta as pilhas dos dois núcleos; deve ser a primeira chamada de main()
+extern void mem_guard_init(void);
+
+// Marca o fim da inicialização: a partir daqui qualquer malloc/free é contado e,
+// se compilado com BABA_TRAP_HEAP, interrompe o programa com panic()
+extern void mem_guard_seal(void);
+
+// Uso máximo (high-water mark) e tamanho da pilha do núcleo indicado, em bytes
+extern void mem_guard_stack_usage(uint core, uint32_t *used, uint32_t *size);
+
+// Operações de heap ocorridas depois de mem_guard_seal()
+extern uint32_t mem_guard_heap_ops_after_boot(void);
+
+#endif
@@ -0,0 +1,296 @@
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "lwip/tcp.h"
+#include "lwip/ip_addr.h"
+#include "lwip/apps/mqtt.h"
+#include "notify.h"
+#include "notify_queue.h"
+
+// Estado do envio em andamento (alterado pelos callbacks do lwIP)
+typedef enum {
+    SEND_IDLE,
+    SEND_BUSY,
+    SEND_DONE_OK,
+    SEND_DONE_FAIL
+} send_state_t;
+
+static const char *event_names[] = {"choro", "ativado", "desativado"};
+
+static notify_config_t notify_cfg;
+static ip_addr_t notify_addr;
+static bool notify_ready = false;
+
+// Fila de saída (agrupamento e backoff em notify_queue.c)
+static notify_queue_t outbox;
+static uint32_t muted_until_ms = 0;
+static bool muted = false;
+
+static volatile send_state_t send_state = SEND_IDLE;
+static uint32_t send_seq = 0;
+static uint32_t send_started_ms = 0;
+
+static char body_buffer[192];
+static char tx_buffer[384];
+static uint16_t tx_len = 0;
+
+static struct tcp_pcb *http_pcb = NULL;
+static mqtt_client_t *mqtt_client = NULL;
+static struct mqtt_connect_client_info_t mqtt_info;
+
+// Compara instantes considerando o estouro do contador de ms
+static inline bool time_reached(uint32_t now_ms, uint32_t target_ms) {
+    return (int32_t)(now_ms - target_ms) >= 0;
+}
+
+// Callbacks carregam o número da tentativa; respostas atrasadas de tentativas antigas são ignoradas
+static inline bool is_current_attempt(void *arg) {
+    return (uint32_t)(uintptr_t)arg == send_seq && send_state == SEND_BUSY;
+}
+
+// ---------- HTTP ----------
+
+static err_t http_client_close(struct tcp_pcb *tpcb) {
+    tcp_arg(tpcb, NULL);
+    tcp_recv(tpcb, NULL);
+    tcp_err(tpcb, NULL);
+    http_pcb = NULL;
+    if (tcp_close(tpcb) != ERR_OK) {
+        tcp_abort(tpcb);
+        return ERR_ABRT;
+    }
+    return ERR_OK;
+}
+
+static err_t http_client_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
+    if (p == NULL) {
+        // Servidor encerrou antes de enviar o status
+        if (is_current_attempt(arg)) {
+            send_state = SEND_DONE_FAIL;
+        }
+        return http_client_close(tpcb);
+    }
+
+    // Só a linha de status interessa: "HTTP/1.x 2xx"
+    char status[13] = {0};
+    pbuf_copy_partial(p, status, sizeof(status) - 1, 0);
+    tcp_recved(tpcb, p->tot_len);
+    pbuf_free(p);
+
+    if (is_current_attempt(arg)) {
+        bool ok = strncmp(status, "HTTP/1.", 7) == 0 && status[9] == '2';
+        send_state = ok ? SEND_DONE_OK : SEND_DONE_FAIL;
+    }
+    return http_client_close(tpcb);
+}
+
+static void http_client_err(void *arg, err_t err) {
+    // O pcb já foi liberado pelo lwIP
+    http_pcb = NULL;
+    if (is_current_attempt(arg)) {
+        send_state = SEND_DONE_FAIL;
+    }
+}
+
+static err_t http_client_connected(void *arg, struct tcp_pcb *tpcb, err_t err) {
+    if (err != ERR_OK || tcp_write(tpcb, tx_buffer, tx_len, TCP_WRITE_FLAG_COPY) != ERR_OK) {
+        if (is_current_attempt(arg)) {
+            send_state = SEND_DONE_FAIL;
+        }
+        return http_client_close(tpcb);
+    }
+    tcp_output(tpcb);
+    return ERR_OK;
+}
+
+static bool http_client_start(int body_len) {
+    int len = snprintf(tx_buffer, sizeof(tx_buffer),
+        "POST %s HTTP/1.1\r\n"
+        "Host: %s\r\n"
+        "Content-Type: application/json\r\n"
+        "Content-Length: %d\r\n"
+        "Connection: close\r\n\r\n"
+        "%s",
+        notify_cfg.path, notify_cfg.host, body_len, body_buffer);
+    if (len <= 0 || len >= (int)sizeof(tx_buffer)) {
+        return false;
+    }
+    tx_len = len;
+
+    http_pcb = tcp_new_ip_type(IPADDR_TYPE_V4);
+    if (http_pcb == NULL) {
+        return false;
+    }
+    tcp_arg(http_pcb, (void *)(uintptr_t)send_seq);
+    tcp_recv(http_pcb, http_client_recv);
+    tcp_err(http_pcb, http_client_err);
+    if (tcp_connect(http_pcb, &notify_addr, notify_cfg.port, http_client_connected) != ERR_OK) {
+        http_client_close(http_pcb);
+        return false;
+    }
+    return true;
+}
+
+// ---------- MQTT ----------
+
+static void mqtt_publish_done(void *arg, err_t result) {
+    if (is_current_attempt(arg)) {
+        send_state = (result == ERR_OK) ? SEND_DONE_OK : SEND_DONE_FAIL;
+    }
+}
+
+static void mqtt_publish_pending(void) {
+    err_t err = mqtt_publish(mqtt_client, notify_cfg.path, tx_buffer, tx_len, 1, 0,
+                             mqtt_publish_done, (void *)(uintptr_t)send_seq);
+    if (err != ERR_OK) {
+        send_state = SEND_DONE_FAIL;
+    }
+}
+
+static void mqtt_connection_changed(mqtt_client_t *client, void *arg, mqtt_connection_status_t status) {
+    if (send_state != SEND_BUSY) {
+        return;
+    }
+    if (status == MQTT_CONNECT_ACCEPTED) {
+        mqtt_publish_pending();
+    } else {
+        send_state = SEND_DONE_FAIL;
+    }
+}
+
+static bool mqtt_start(int body_len) {
+    memcpy(tx_buffer, body_buffer, body_len);
+    tx_len = body_len;
+
+    // A conexão com o broker é mantida entre mensagens
+    if (mqtt_client_is_connected(mqtt_client)) {
+        mqtt_publish_pending();
+        return send_state == SEND_BUSY;
+    }
+    return mqtt_client_connect(mqtt_client, &notify_addr, notify_cfg.port,
+                               mqtt_connection_changed, NULL, &mqtt_info) == ERR_OK;
+}
+
+// ---------- Fila ----------
+
+static void send_finished(bool ok, uint32_t now_ms) {
+    uint32_t backoff_ms = notify_queue_done(&outbox, ok, now_ms);
+    if (!ok) {
+        printf("Notificacao falhou, nova tentativa em %lu ms\n", (unsigned long)backoff_ms);
+    }
+    send_state = SEND_IDLE;
+}
+
+static void send_abort(void) {
+    if (notify_cfg.proto == NOTIFY_PROTO_HTTP) {
+        if (http_pcb) {
+            struct tcp_pcb *pcb = http_pcb;
+            tcp_arg(pcb, NULL);
+            tcp_err(pcb, NULL);
+            tcp_recv(pcb, NULL);
+            http_pcb = NULL;
+            tcp_abort(pcb);
+        }
+    } else {
+        mqtt_disconnect(mqtt_client);
+    }
+}
+
+static void send_start(const notify_entry_t *entry, uint32_t now_ms) {
+    int body_len = snprintf(body_buffer, sizeof(body_buffer),
+        "{\"device\":\"%s\",\"event\":\"%s\",\"count\":%u,\"peak_activity\":%u,"
+        "\"age_ms\":%lu,\"duration_ms\":%lu}",
+        notify_cfg.device_id, event_names[entry->type], entry->count, entry->peak_activity,
+        (unsigned long)(now_ms - entry->first_ms),
+        (unsigned long)(entry->last_ms - entry->first_ms));
+    if (body_len >= (int)sizeof(body_buffer)) {
+        body_len = sizeof(body_buffer) - 1;
+    }
+
+    send_seq++;
+    send_state = SEND_BUSY;
+    send_started_ms = now_ms;
+
+    bool started = notify_cfg.proto == NOTIFY_PROTO_HTTP ? http_client_start(body_len)
+                                                         : mqtt_start(body_len);
+    if (!started) {
+        send_finished(false, now_ms);
+    }
+}
+
+bool notify_init(const notify_config_t *config) {
+    notify_cfg = *config;
+    notify_queue_init(&outbox);
+    if (!ipaddr_aton(notify_cfg.host, &notify_addr)) {
+        printf("Endereco de notificacao invalido: %s\n", notify_cfg.host);
+        return false;
+    }
+
+    if (notify_cfg.proto == NOTIFY_PROTO_MQTT) {
+        cyw43_arch_lwip_begin();
+        mqtt_client = mqtt_client_new();
+        cyw43_arch_lwip_end();
+        if (mqtt_client == NULL) {
+            return false;
+        }
+        memset(&mqtt_info, 0, sizeof(mqtt_info));
+        mqtt_info.client_id = notify_cfg.device_id;
+        mqtt_info.keep_alive = 60;
+    }
+
+    notify_ready = true;
+    return true;
+}
+
+void notify_mute(uint32_t duration_ms, uint32_t now_ms) {
+    muted = duration_ms > 0;
+    muted_until_ms = now_ms + duration_ms;
+}
+
+bool notify_is_muted(uint32_t now_ms) {
+    if (muted && time_reached(now_ms, muted_until_ms)) {
+        muted = false;
+    }
+    return muted;
+}
+
+void notify_push(notify_event_type_t type, uint8_t activity, uint32_t now_ms) {
+    if (notify_is_muted(now_ms)) {
+        return;
+    }
+
+    cyw43_arch_lwip_begin();
+    notify_queue_push(&outbox, type, activity, now_ms);
+    cyw43_arch_lwip_end();
+}
+
+void notify_poll(uint32_t now_ms) {
+    if (!notify_ready) {
+        return;
+    }
+
+    cyw43_arch_lwip_begin();
+
+    if (send_state == SEND_DONE_OK) {
+        send_finished(true, now_ms);
+    } else if (send_state == SEND_DONE_FAIL) {
+        send_finished(false, now_ms);
+    } else if (send_state == SEND_BUSY && now_ms - send_started_ms >= NOTIFY_TIMEOUT_MS) {
+        send_abort();
+        send_finished(false, now_ms);
+    }
+
+    if (send_state == SEND_IDLE) {
+        const notify_entry_t *entry = notify_queue_next(&outbox, now_ms);
+        if (entry != NULL) {
+            send_start(entry, now_ms);
+        }
+    }
+
+    cyw43_arch_lwip_end();
+}
+
+uint32_t notify_dropped_count(void) {
+    return outbox.dropped;
+}
@@ -0,0 +1,51 @@
+#ifndef notify_inc_h
+#define notify_inc_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define NOTIFY_OUTBOX_SIZE 8          // Eventos guardados em RAM aguardando envio
+#define NOTIFY_COALESCE_MS 5000       // Janela para agrupar eventos do mesmo tipo
+#define NOTIFY_TIMEOUT_MS 8000        // Tempo máximo de uma tentativa de envio
+#define NOTIFY_BACKOFF_MIN_MS 1000    // Primeira espera após falha
+#define NOTIFY_BACKOFF_MAX_MS 60000   // Espera máxima entre tentativas
+
+// Protocolo usado para entregar as notificações
+typedef enum {
+    NOTIFY_PROTO_HTTP,  // POST com corpo JSON
+    NOTIFY_PROTO_MQTT   // Publicação QoS 1 no tópico configurado
+} notify_proto_t;
+
+typedef enum {
+    NOTIFY_EVT_CRY,
+    NOTIFY_EVT_ACTIVATED,
+    NOTIFY_EVT_DEACTIVATED
+} notify_event_type_t;
+
+typedef struct {
+    notify_proto_t proto;
+    const char *host;       // IPv4 do servidor/broker local (ex.: "192.168.0.10")
+    uint16_t port;
+    const char *path;       // HTTP: caminho do POST / MQTT: tópico
+    const char *device_id;  // Identificação do dispositivo no corpo da mensagem
+} notify_config_t;
+
+// Configura o cliente. O envio só começa quando houver eventos na fila.
+extern bool notify_init(const notify_config_t *config);
+
+// Enfileira um evento (não bloqueia). Eventos iguais dentro de NOTIFY_COALESCE_MS
+// viram uma única mensagem. Com a fila cheia o evento mais antigo é descartado.
+extern void notify_push(notify_event_type_t type, uint8_t activity, uint32_t now_ms);
+
+// Avança a máquina de envio; deve ser chamada periodicamente pelo loop principal.
+extern void notify_poll(uint32_t now_ms);
+
+// Silencia as notificações por duration_ms; eventos nesse período são descartados (0 reativa)
+extern void notify_mute(uint32_t duration_ms, uint32_t now_ms);
+
+extern bool notify_is_muted(uint32_t now_ms);
+
+// Quantidade de eventos descartados por falta de espaço na fila
+extern uint32_t notify_dropped_count(void);
+
+#endif
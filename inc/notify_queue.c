@@ -0,0 +1,84 @@
+#include <string.h>
+#include "notify_queue.h"
+
+// Compara instantes considerando o estouro do contador de ms
+static inline bool time_reached(uint32_t now_ms, uint32_t target_ms) {
+    return (int32_t)(now_ms - target_ms) >= 0;
+}
+
+void notify_queue_init(notify_queue_t *queue) {
+    memset(queue, 0, sizeof(*queue));
+}
+
+void notify_queue_push(notify_queue_t *queue, notify_event_type_t type, uint8_t activity, uint32_t now_ms) {
+    // Agrupa com o último evento se ele ainda não está sendo enviado
+    if (queue->count > 0) {
+        unsigned tail = (queue->head + queue->count - 1) % NOTIFY_OUTBOX_SIZE;
+        notify_entry_t *last = &queue->entries[tail];
+        bool in_flight = queue->in_flight && tail == queue->head;
+        if (!in_flight && last->type == type && now_ms - last->first_ms < NOTIFY_COALESCE_MS) {
+            if (last->count < UINT16_MAX) {
+                last->count++;
+            }
+            if (activity > last->peak_activity) {
+                last->peak_activity = activity;
+            }
+            last->last_ms = now_ms;
+            return;
+        }
+    }
+
+    // Fila cheia: descarta o mais antigo, desde que não esteja em envio
+    if (queue->count == NOTIFY_OUTBOX_SIZE) {
+        unsigned tail = (queue->head + queue->count - 1) % NOTIFY_OUTBOX_SIZE;
+        unsigned victim = queue->in_flight ? (queue->head + 1) % NOTIFY_OUTBOX_SIZE : queue->head;
+        for (unsigned i = victim; i != tail; i = (i + 1) % NOTIFY_OUTBOX_SIZE) {
+            queue->entries[i] = queue->entries[(i + 1) % NOTIFY_OUTBOX_SIZE];
+        }
+        queue->count--;
+        queue->dropped++;
+    }
+
+    notify_entry_t *entry = &queue->entries[(queue->head + queue->count) % NOTIFY_OUTBOX_SIZE];
+    entry->type = type;
+    entry->peak_activity = activity;
+    entry->count = 1;
+    entry->first_ms = now_ms;
+    entry->last_ms = now_ms;
+    queue->count++;
+}
+
+const notify_entry_t *notify_queue_next(notify_queue_t *queue, uint32_t now_ms) {
+    if (queue->in_flight || queue->count == 0) {
+        return NULL;
+    }
+    // Sem falha pendente não há espera: um next_attempt_ms antigo viraria "futuro" após 2^31 ms
+    if (queue->backoff_ms > 0 && !time_reached(now_ms, queue->next_attempt_ms)) {
+        return NULL;
+    }
+    // Só envia depois que a janela de agrupamento do evento mais antigo fechou
+    const notify_entry_t *entry = &queue->entries[queue->head];
+    if (now_ms - entry->first_ms < NOTIFY_COALESCE_MS) {
+        return NULL;
+    }
+    queue->in_flight = true;
+    return entry;
+}
+
+uint32_t notify_queue_done(notify_queue_t *queue, bool ok, uint32_t now_ms) {
+    queue->in_flight = false;
+    if (ok) {
+        queue->head = (queue->head + 1) % NOTIFY_OUTBOX_SIZE;
+        queue->count--;
+        queue->backoff_ms = 0;
+        queue->next_attempt_ms = now_ms;
+        return 0;
+    }
+    // Backoff exponencial entre as tentativas
+    queue->backoff_ms = queue->backoff_ms ? queue->backoff_ms * 2 : NOTIFY_BACKOFF_MIN_MS;
+    if (queue->backoff_ms > NOTIFY_BACKOFF_MAX_MS) {
+        queue->backoff_ms = NOTIFY_BACKOFF_MAX_MS;
+    }
+    queue->next_attempt_ms = now_ms + queue->backoff_ms;
+    return queue->backoff_ms;
+}
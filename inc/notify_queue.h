@@ -0,0 +1,42 @@
+#ifndef notify_queue_inc_h
+#define notify_queue_inc_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "notify.h"
+
+// Evento na fila de saída (eventos agrupados acumulam contagem e pico)
+typedef struct {
+    notify_event_type_t type;
+    uint8_t peak_activity;
+    uint16_t count;
+    uint32_t first_ms;
+    uint32_t last_ms;
+} notify_entry_t;
+
+// Fila circular limitada com agrupamento e backoff, sem acesso à rede: o notify.c faz o envio
+typedef struct {
+    notify_entry_t entries[NOTIFY_OUTBOX_SIZE];
+    uint8_t head;
+    uint8_t count;
+    bool in_flight;            // O primeiro da fila está sendo enviado
+    uint32_t dropped;
+    uint32_t backoff_ms;       // 0 = nenhuma falha desde o último envio
+    uint32_t next_attempt_ms;
+} notify_queue_t;
+
+extern void notify_queue_init(notify_queue_t *queue);
+
+// Agrupa com o último evento do mesmo tipo dentro de NOTIFY_COALESCE_MS ou acrescenta um novo.
+// Com a fila cheia descarta o mais antigo que não esteja em envio.
+extern void notify_queue_push(notify_queue_t *queue, notify_event_type_t type, uint8_t activity, uint32_t now_ms);
+
+// Evento a enviar agora (janela de agrupamento fechada e backoff vencido), marcado como em envio;
+// NULL se não houver
+extern const notify_entry_t *notify_queue_next(notify_queue_t *queue, uint32_t now_ms);
+
+// Resultado do envio: sucesso retira o evento e zera o backoff; falha dobra a espera
+// (NOTIFY_BACKOFF_MIN_MS até NOTIFY_BACKOFF_MAX_MS) e mantém o evento. Retorna a espera.
+extern uint32_t notify_queue_done(notify_queue_t *queue, bool ok, uint32_t now_ms);
+
+#endif
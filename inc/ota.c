@@ -0,0 +1,169 @@
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/watchdog.h"
+#include "ota.h"
+#include "flash_store.h"
+
+static_assert(OTA_SLOT_B + OTA_SLOT_SIZE <= FLASH_STORE_OFFSET, "slots de firmware invadem a regiao de dados");
+
+extern char __flash_binary_end;  // Fim da imagem em execução (linker script)
+
+static const uint8_t *ota_flash_read(uint32_t offset) {
+    return (const uint8_t *)(uintptr_t)(XIP_BASE + offset);
+}
+
+static const ota_flash_t ota_flash = {
+    .read = ota_flash_read,
+    .erase_program = flash_store_write_raw,
+    .program = flash_store_program_raw,
+    .control = FLASH_STORE_OFFSET + FLASH_STORE_OTA,
+    .journal = FLASH_STORE_OFFSET + FLASH_STORE_OTA_JOURNAL,
+    .scratch = FLASH_STORE_OFFSET + FLASH_STORE_OTA_SCRATCH
+};
+
+static ota_control_t control;
+static ota_writer_t writer;       // Um setor em RAM; a imagem nunca fica inteira na memória
+static uint8_t expected[SHA256_DIGEST_SIZE];
+static bool receiving = false;
+static uint32_t upload_start_ms;
+static volatile uint32_t reboot_at_ms = 0;  // 0 = nenhum reinício agendado
+
+static repeating_timer_t trial_timer;
+static uint32_t trial_deadline_ms;
+
+// Alimenta o watchdog do bootloader até o prazo; sem confirmação ele reinicia e a troca é desfeita
+static bool trial_timer_callback(repeating_timer_t *timer) {
+    if (to_ms_since_boot(get_absolute_time()) >= trial_deadline_ms) {
+        return false;
+    }
+    watchdog_update();
+    return true;
+}
+
+static const char *ota_state_name(uint8_t state) {
+    static const char *const names[] = { "idle", "pending", "swap_in", "trial", "swap_back" };
+    return state < count_of(names) ? names[state] : "?";
+}
+
+static const char *ota_result_name(uint8_t result) {
+    static const char *const names[] = { "none", "updated", "rolled_back", "invalid" };
+    return result < count_of(names) ? names[result] : "?";
+}
+
+void ota_init(void) {
+    ota_control_load(&ota_flash, &control);
+    if (control.state == OTA_STATE_TRIAL) {
+        trial_deadline_ms = to_ms_since_boot(get_absolute_time()) + OTA_CONFIRM_TIMEOUT_MS;
+        watchdog_update();
+        add_repeating_timer_ms(1000, trial_timer_callback, NULL, &trial_timer);
+        printf("Firmware novo em teste (troca: %lu ms)\n", (unsigned long)control.swap_ms);
+    } else if (control.result != OTA_RESULT_NONE) {
+        printf("Ultima atualizacao: %s\n", ota_result_name(control.result));
+    }
+}
+
+void ota_confirm(void) {
+    if (control.state != OTA_STATE_TRIAL) {
+        return;
+    }
+    cancel_repeating_timer(&trial_timer);
+    hw_clear_bits(&watchdog_hw->ctrl, WATCHDOG_CTRL_ENABLE_BITS);
+
+    control.state = OTA_STATE_IDLE;
+    control.result = OTA_RESULT_UPDATED;
+    control.confirm_ms = to_ms_since_boot(get_absolute_time());
+    if (!ota_control_store(&ota_flash, &control)) {
+        printf("Falha ao confirmar o firmware\n");
+        return;
+    }
+    printf("Firmware confirmado (envio %lu ms, troca %lu ms, confirmacao %lu ms)\n",
+           (unsigned long)control.upload_ms, (unsigned long)control.swap_ms, (unsigned long)control.confirm_ms);
+}
+
+bool ota_parse_digest(const char *hex, uint8_t digest[SHA256_DIGEST_SIZE]) {
+    for (int i = 0; i < SHA256_DIGEST_SIZE * 2; i++) {
+        char c = hex[i];
+        int value;
+        if (c >= '0' && c <= '9') {
+            value = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            value = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            value = c - 'A' + 10;
+        } else {
+            return false;
+        }
+        digest[i / 2] = (i & 1) ? (digest[i / 2] | value) : (value << 4);
+    }
+    return hex[SHA256_DIGEST_SIZE * 2] == '\0';
+}
+
+bool ota_begin(uint32_t size, const uint8_t digest[SHA256_DIGEST_SIZE]) {
+    if (receiving || reboot_at_ms != 0 || control.state != OTA_STATE_IDLE || size > OTA_SLOT_SIZE) {
+        return false;
+    }
+    memcpy(expected, digest, SHA256_DIGEST_SIZE);
+    ota_writer_begin(&writer, &ota_flash, OTA_SLOT_B, size);
+    upload_start_ms = to_ms_since_boot(get_absolute_time());
+    receiving = true;
+    printf("Recebendo firmware (%lu bytes)\n", (unsigned long)size);
+    return true;
+}
+
+bool ota_write(const uint8_t *data, uint16_t len) {
+    return receiving && ota_writer_write(&writer, data, len);
+}
+
+ota_upload_result_t ota_end(void) {
+    receiving = false;
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    if (!ota_writer_finish(&writer, digest)) {
+        return writer.failed ? OTA_UPLOAD_FLASH_ERROR : OTA_UPLOAD_INCOMPLETE;
+    }
+    // O que ficou gravado já foi relido setor a setor pelo ota_writer; o bootloader confere o hash
+    if (memcmp(digest, expected, SHA256_DIGEST_SIZE) != 0) {
+        return OTA_UPLOAD_BAD_HASH;
+    }
+    if (!ota_image_plausible(&ota_flash, OTA_SLOT_B, writer.size)) {
+        return OTA_UPLOAD_BAD_IMAGE;
+    }
+    // A troca cobre a maior das duas imagens para que a anterior volte inteira no rollback
+    uint32_t running_size = (uintptr_t)&__flash_binary_end - (XIP_BASE + OTA_SLOT_A);
+    uint32_t swap_size = writer.size > running_size ? writer.size : running_size;
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    control.state = OTA_STATE_PENDING;
+    control.result = OTA_RESULT_NONE;
+    control.image_size = writer.size;
+    control.swap_size = (swap_size + OTA_SECTOR_SIZE - 1) & ~(OTA_SECTOR_SIZE - 1);
+    control.upload_ms = now_ms - upload_start_ms;
+    control.swap_ms = 0;
+    control.confirm_ms = 0;
+    memcpy(control.sha256, expected, SHA256_DIGEST_SIZE);
+    if (!ota_control_store(&ota_flash, &control)) {
+        control.state = OTA_STATE_IDLE;
+        return OTA_UPLOAD_FLASH_ERROR;
+    }
+    printf("Firmware recebido e verificado em %lu ms; reiniciando\n", (unsigned long)control.upload_ms);
+    reboot_at_ms = now_ms + OTA_REBOOT_DELAY_MS;
+    return OTA_UPLOAD_OK;
+}
+
+void ota_abort(void) {
+    receiving = false;
+}
+
+void ota_poll(uint32_t now_ms) {
+    if (reboot_at_ms != 0 && (int32_t)(now_ms - reboot_at_ms) >= 0) {
+        watchdog_reboot(0, 0, 0);
+    }
+}
+
+void ota_write_status(http_response_t *response) {
+    http_response_printf(response, "{\"state\":\"%s\",\"result\":\"%s\",\"image_size\":%lu,"
+                                   "\"upload_ms\":%lu,\"swap_ms\":%lu,\"confirm_ms\":%lu,\"received\":%lu}",
+                         ota_state_name(control.state), ota_result_name(control.result),
+                         (unsigned long)control.image_size, (unsigned long)control.upload_ms,
+                         (unsigned long)control.swap_ms, (unsigned long)control.confirm_ms,
+                         (unsigned long)(receiving ? writer.received : 0));
+}
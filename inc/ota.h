@@ -0,0 +1,46 @@
+#ifndef ota_inc_h
+#define ota_inc_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "http_server.h"
+#include "ota_image.h"
+
+#define OTA_CONFIRM_TIMEOUT_MS 60000  // Prazo da imagem nova para chamar ota_confirm()
+#define OTA_REBOOT_DELAY_MS 500       // Tempo para a resposta HTTP sair antes de reiniciar
+
+typedef enum {
+    OTA_UPLOAD_OK = 0,
+    OTA_UPLOAD_INCOMPLETE,  // Corpo menor que o Content-Length
+    OTA_UPLOAD_BAD_HASH,    // SHA-256 diferente do informado
+    OTA_UPLOAD_BAD_IMAGE,   // Não parece uma imagem para o slot A
+    OTA_UPLOAD_FLASH_ERROR  // Falha na gravação ou na releitura
+} ota_upload_result_t;
+
+// Lê o registro de controle. Na imagem em teste mantém o watchdog alimentado até
+// ota_confirm() ou até OTA_CONFIRM_TIMEOUT_MS; depois do prazo o bootloader desfaz a troca.
+extern void ota_init(void);
+
+// Marca a imagem em teste como boa (não faz nada fora do teste)
+extern void ota_confirm(void);
+
+// Converte os 64 dígitos hexadecimais do hash informado pelo cliente
+extern bool ota_parse_digest(const char *hex, uint8_t digest[SHA256_DIGEST_SIZE]);
+
+// Recepção em fluxo para o slot B; false se já houver uma atualização em andamento ou pendente.
+// ota_write e ota_end gravam a flash: são chamadas pelo http_server_poll, fora do contexto do lwIP.
+extern bool ota_begin(uint32_t size, const uint8_t digest[SHA256_DIGEST_SIZE]);
+extern bool ota_write(const uint8_t *data, uint16_t len);
+
+// Fecha a gravação (cada setor já foi relido da flash), confere o hash calculado no fluxo e
+// agenda o reinício
+extern ota_upload_result_t ota_end(void);
+extern void ota_abort(void);
+
+// Reinicia quando a atualização recebida estiver pronta; chamada periodicamente pelo loop principal
+extern void ota_poll(uint32_t now_ms);
+
+// Estado e tempos da última atualização em JSON
+extern void ota_write_status(http_response_t *response);
+
+#endif
@@ -0,0 +1,282 @@
+#include <string.h>
+#include "ota_image.h"
+
+#define OTA_MAGIC_0 'O'
+#define OTA_MAGIC_1 'T'
+#define OTA_VERSION 1
+
+// Três passos por setor: A -> rascunho, B -> A, rascunho -> B. Cada passo é um byte zerado no diário:
+// a primeira metade registra a troca e a segunda o rollback, que assim não precisa apagar o diário.
+#define OTA_SWAP_STEPS 3
+#define OTA_UNDO_JOURNAL (OTA_SECTOR_SIZE / 2)
+_Static_assert(OTA_SWAP_STEPS * (OTA_SLOT_SIZE / OTA_SECTOR_SIZE) + 2 <= OTA_UNDO_JOURNAL,
+               "diario da troca nao cabe em meio setor");
+
+// Cópia de setor para a RAM (a flash não pode ser lida pelo XIP durante a gravação)
+static uint8_t ota_buffer[OTA_SECTOR_SIZE];
+
+static uint32_t read_u32(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void ota_writer_begin(ota_writer_t *writer, const ota_flash_t *flash, uint32_t base, uint32_t size) {
+    writer->flash = flash;
+    writer->base = base;
+    writer->size = size;
+    writer->received = 0;
+    writer->fill = 0;
+    writer->failed = false;
+    sha256_init(&writer->hash);
+}
+
+static bool ota_writer_flush(ota_writer_t *writer) {
+    uint32_t offset = writer->base + writer->received - writer->fill;
+    memset(writer->sector + writer->fill, 0xFF, OTA_SECTOR_SIZE - writer->fill);
+    // Relê o setor logo após a gravação: a imagem inteira não precisa ser relida no fim
+    if (!writer->flash->erase_program(offset, writer->sector, OTA_SECTOR_SIZE) ||
+        memcmp(writer->flash->read(offset), writer->sector, OTA_SECTOR_SIZE) != 0) {
+        writer->failed = true;
+        return false;
+    }
+    writer->fill = 0;
+    return true;
+}
+
+bool ota_writer_write(ota_writer_t *writer, const uint8_t *data, uint32_t len) {
+    if (writer->failed || len > writer->size - writer->received) {
+        writer->failed = true;
+        return false;
+    }
+    sha256_update(&writer->hash, data, len);
+    while (len > 0) {
+        uint32_t chunk = OTA_SECTOR_SIZE - writer->fill;
+        if (chunk > len) {
+            chunk = len;
+        }
+        memcpy(writer->sector + writer->fill, data, chunk);
+        writer->fill += chunk;
+        writer->received += chunk;
+        data += chunk;
+        len -= chunk;
+        if (writer->fill == OTA_SECTOR_SIZE && !ota_writer_flush(writer)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ota_writer_finish(ota_writer_t *writer, uint8_t digest[SHA256_DIGEST_SIZE]) {
+    if (writer->failed || writer->received != writer->size) {
+        return false;
+    }
+    if (writer->fill > 0 && !ota_writer_flush(writer)) {
+        return false;
+    }
+    sha256_final(&writer->hash, digest);
+    return true;
+}
+
+bool ota_image_verify(const ota_flash_t *flash, uint32_t base, uint32_t size,
+                      const uint8_t digest[SHA256_DIGEST_SIZE]) {
+    if (size == 0 || size > OTA_SLOT_SIZE) {
+        return false;
+    }
+    uint8_t actual[SHA256_DIGEST_SIZE];
+    sha256_t hash;
+    sha256_init(&hash);
+    for (uint32_t offset = 0; offset < size; offset += OTA_SECTOR_SIZE) {
+        uint32_t chunk = size - offset < OTA_SECTOR_SIZE ? size - offset : OTA_SECTOR_SIZE;
+        sha256_update(&hash, flash->read(base + offset), chunk);
+    }
+    sha256_final(&hash, actual);
+    return memcmp(actual, digest, SHA256_DIGEST_SIZE) == 0;
+}
+
+bool ota_image_plausible(const ota_flash_t *flash, uint32_t base, uint32_t size) {
+    if (size < OTA_VECTOR_OFFSET + 8 || size > OTA_SLOT_SIZE) {
+        return false;
+    }
+    const uint8_t *vectors = flash->read(base + OTA_VECTOR_OFFSET);
+    uint32_t stack = read_u32(vectors);
+    uint32_t reset = read_u32(vectors + 4);
+    uint32_t start = OTA_XIP_BASE + OTA_SLOT_A + OTA_VECTOR_OFFSET;
+    return stack > OTA_RAM_BASE && stack <= OTA_RAM_END &&
+           (reset & 1) != 0 && reset > start && reset < OTA_XIP_BASE + OTA_SLOT_A + size;
+}
+
+bool ota_control_load(const ota_flash_t *flash, ota_control_t *control) {
+    memcpy(control, flash->read(flash->control), sizeof(*control));
+    if (control->magic[0] == OTA_MAGIC_0 && control->magic[1] == OTA_MAGIC_1 &&
+        control->version == OTA_VERSION) {
+        return true;
+    }
+    memset(control, 0, sizeof(*control));
+    control->magic[0] = OTA_MAGIC_0;
+    control->magic[1] = OTA_MAGIC_1;
+    control->version = OTA_VERSION;
+    return false;
+}
+
+bool ota_control_store(const ota_flash_t *flash, const ota_control_t *control) {
+    memcpy(ota_buffer, control, sizeof(*control));
+    return flash->erase_program(flash->control, ota_buffer, sizeof(*control));
+}
+
+bool ota_journal_reset(const ota_flash_t *flash) {
+    memset(ota_buffer, 0xFF, OTA_PAGE_SIZE);
+    return flash->erase_program(flash->journal, ota_buffer, OTA_PAGE_SIZE);
+}
+
+// Passos já concluídos: bytes zerados a partir de first (0 = troca, OTA_UNDO_JOURNAL = rollback)
+static uint32_t ota_journal_steps(const ota_flash_t *flash, uint32_t first) {
+    const uint8_t *journal = flash->read(flash->journal) + first;
+    uint32_t steps = 0;
+    while (steps < OTA_UNDO_JOURNAL && journal[steps] == 0) {
+        steps++;
+    }
+    return steps;
+}
+
+// Zera o byte do passo sem apagar o setor (os demais bytes da página ficam em 0xFF)
+static bool ota_journal_mark(const ota_flash_t *flash, uint32_t index) {
+    memset(ota_buffer, 0xFF, OTA_PAGE_SIZE);
+    ota_buffer[index % OTA_PAGE_SIZE] = 0;
+    return flash->program(flash->journal + index - index % OTA_PAGE_SIZE, ota_buffer, OTA_PAGE_SIZE);
+}
+
+static bool ota_copy_sector(const ota_flash_t *flash, uint32_t dst, uint32_t src) {
+    memcpy(ota_buffer, flash->read(src), OTA_SECTOR_SIZE);
+    return flash->erase_program(dst, ota_buffer, OTA_SECTOR_SIZE);
+}
+
+// Um passo da troca do setor (a troca é a própria inversa: repetida, desfaz o setor)
+static bool ota_swap_step(const ota_flash_t *flash, uint32_t sector, uint32_t phase) {
+    uint32_t a = OTA_SLOT_A + sector * OTA_SECTOR_SIZE;
+    uint32_t b = OTA_SLOT_B + sector * OTA_SECTOR_SIZE;
+    switch (phase) {
+    case 0:
+        return ota_copy_sector(flash, flash->scratch, a);
+    case 1:
+        return ota_copy_sector(flash, a, b);
+    default:
+        return ota_copy_sector(flash, b, flash->scratch);
+    }
+}
+
+static uint32_t ota_swap_sectors(uint32_t size) {
+    return (size + OTA_SECTOR_SIZE - 1) / OTA_SECTOR_SIZE;
+}
+
+bool ota_swap(const ota_flash_t *flash, uint32_t size) {
+    uint32_t sectors = ota_swap_sectors(size);
+    if (sectors > OTA_SLOT_SIZE / OTA_SECTOR_SIZE) {
+        return false;
+    }
+    for (uint32_t step = ota_journal_steps(flash, 0); step < sectors * OTA_SWAP_STEPS; step++) {
+        if (!ota_swap_step(flash, step / OTA_SWAP_STEPS, step % OTA_SWAP_STEPS) ||
+            !ota_journal_mark(flash, step)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t ota_swap_progress(const ota_flash_t *flash) {
+    return ota_journal_steps(flash, 0);
+}
+
+// Passos do rollback: primeiro o setor interrompido (done % 3 passos), depois os setores
+// completos em ordem inversa. No setor interrompido a cópia original de A está no rascunho e,
+// se o passo 1 terminou, a de B está em A (o passo 2 pode ter deixado B pela metade).
+bool ota_swap_undo(const ota_flash_t *flash, uint32_t size, uint32_t done) {
+    uint32_t sectors = ota_swap_sectors(size);
+    if (sectors > OTA_SLOT_SIZE / OTA_SECTOR_SIZE) {
+        return false;
+    }
+    if (done > sectors * OTA_SWAP_STEPS) {
+        done = sectors * OTA_SWAP_STEPS;  // Registro sem swap_steps: desfaz a troca inteira
+    }
+    uint32_t full = done / OTA_SWAP_STEPS;
+    uint32_t partial = done % OTA_SWAP_STEPS;  // 0 = nada a desfazer no setor interrompido
+    uint32_t total = partial + full * OTA_SWAP_STEPS;
+    for (uint32_t step = ota_journal_steps(flash, OTA_UNDO_JOURNAL); step < total; step++) {
+        bool ok;
+        if (step < partial) {
+            uint32_t a = OTA_SLOT_A + full * OTA_SECTOR_SIZE;
+            uint32_t b = OTA_SLOT_B + full * OTA_SECTOR_SIZE;
+            ok = step + 1 < partial ? ota_copy_sector(flash, b, a)           // B volta de A
+                                    : ota_copy_sector(flash, a, flash->scratch);
+        } else {
+            uint32_t k = step - partial;
+            ok = ota_swap_step(flash, full - 1 - k / OTA_SWAP_STEPS, k % OTA_SWAP_STEPS);
+        }
+        if (!ok || !ota_journal_mark(flash, OTA_UNDO_JOURNAL + step)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Entra em SWAP_BACK guardando quantos passos da troca desfazer; retomado após uma queda de energia
+static void ota_roll_back(const ota_flash_t *flash, ota_control_t *control, ota_result_t result,
+                          uint32_t done) {
+    control->state = OTA_STATE_SWAP_BACK;
+    control->result = result;
+    control->swap_steps = done;
+    if (!ota_control_store(flash, control)) {
+        return;
+    }
+    if (!ota_swap_undo(flash, control->swap_size, control->swap_steps)) {
+        return;
+    }
+    control->state = OTA_STATE_IDLE;
+    ota_control_store(flash, control);
+}
+
+bool ota_boot(const ota_flash_t *flash, ota_control_t *control, uint32_t (*now_us)(void)) {
+    ota_control_load(flash, control);
+
+    switch (control->state) {
+    case OTA_STATE_PENDING:
+        // Confere de novo antes de tocar no slot A: a imagem pode ter sido corrompida após o envio
+        if (!ota_image_verify(flash, OTA_SLOT_B, control->image_size, control->sha256)) {
+            control->state = OTA_STATE_IDLE;
+            control->result = OTA_RESULT_INVALID;
+            ota_control_store(flash, control);
+            return false;
+        }
+        if (!ota_journal_reset(flash)) {
+            return false;
+        }
+        control->state = OTA_STATE_SWAP_IN;
+        if (!ota_control_store(flash, control)) {
+            return false;
+        }
+        // fall through
+    case OTA_STATE_SWAP_IN: {
+        uint32_t start = now_us();
+        if (!ota_swap(flash, control->swap_size) ||
+            !ota_image_verify(flash, OTA_SLOT_A, control->image_size, control->sha256)) {
+            // Desfaz só o que a troca chegou a fazer (tudo, se a falha foi na verificação)
+            ota_roll_back(flash, control, OTA_RESULT_INVALID, ota_swap_progress(flash));
+            return false;
+        }
+        control->swap_ms += (now_us() - start) / 1000;
+        control->state = OTA_STATE_TRIAL;
+        return ota_control_store(flash, control);
+    }
+    case OTA_STATE_TRIAL:
+        // A imagem nova reiniciou (watchdog ou prazo esgotado) sem confirmar
+        ota_roll_back(flash, control, OTA_RESULT_ROLLED_BACK,
+                      ota_swap_sectors(control->swap_size) * OTA_SWAP_STEPS);
+        return false;
+    case OTA_STATE_SWAP_BACK:
+        if (ota_swap_undo(flash, control->swap_size, control->swap_steps)) {
+            control->state = OTA_STATE_IDLE;
+            ota_control_store(flash, control);
+        }
+        return false;
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,116 @@
+#ifndef ota_image_inc_h
+#define ota_image_inc_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sha256.h"
+
+// Mapa da flash (deslocamentos absolutos; deve coincidir com baba_flash_region no CMakeLists.txt)
+#define OTA_XIP_BASE 0x10000000u
+#define OTA_SECTOR_SIZE 4096
+#define OTA_PAGE_SIZE 256
+#define OTA_BOOTLOADER_SIZE (32 * 1024)                     // bootloader/ (com o boot2)
+#define OTA_SLOT_SIZE (960 * 1024)
+#define OTA_SLOT_A OTA_BOOTLOADER_SIZE                      // Imagem em execução
+#define OTA_SLOT_B (OTA_SLOT_A + OTA_SLOT_SIZE)             // Imagem recebida / anterior
+#define OTA_VECTOR_OFFSET 0x100                             // A imagem começa pelo boot2 (256 bytes)
+#define OTA_WATCHDOG_MS 8000                                // Watchdog ligado pelo bootloader na imagem em teste
+
+#define OTA_RAM_BASE 0x20000000u
+#define OTA_RAM_END 0x20042000u
+
+typedef enum {
+    OTA_STATE_IDLE = 0,
+    OTA_STATE_PENDING,      // Imagem nova verificada no slot B, aguardando a troca
+    OTA_STATE_SWAP_IN,      // Bootloader trocando os slots (retomado após queda de energia)
+    OTA_STATE_TRIAL,        // Imagem nova em teste: precisa confirmar antes do prazo
+    OTA_STATE_SWAP_BACK     // Teste falhou: bootloader desfazendo a troca
+} ota_state_t;
+
+typedef enum {
+    OTA_RESULT_NONE = 0,
+    OTA_RESULT_UPDATED,     // Imagem nova confirmada
+    OTA_RESULT_ROLLED_BACK, // Imagem nova não confirmou a tempo; a anterior voltou
+    OTA_RESULT_INVALID      // Hash divergente no bootloader; nada foi trocado (ou foi desfeito)
+} ota_result_t;
+
+// Registro de controle (um setor), compartilhado entre a aplicação e o bootloader
+typedef struct {
+    uint8_t magic[2];
+    uint8_t version;
+    uint8_t state;          // ota_state_t
+    uint8_t result;         // ota_result_t da última atualização
+    uint8_t reserved[3];
+    uint32_t image_size;    // Tamanho da imagem nova
+    uint32_t swap_size;     // Bytes trocados entre os slots (maior das duas imagens, em setores)
+    uint32_t upload_ms;     // Recepção + gravação + verificação
+    uint32_t swap_ms;       // Troca feita pelo bootloader
+    uint32_t confirm_ms;    // Do boot da imagem nova até a confirmação
+    uint8_t sha256[SHA256_DIGEST_SIZE];
+    uint32_t swap_steps;    // Passos da troca a desfazer no SWAP_BACK (0xFFFFFFFF = troca inteira)
+} ota_control_t;
+
+// Acesso à flash: no dispositivo usa o XIP e flash_store; num teste pode ser um arquivo em RAM
+typedef struct {
+    const uint8_t *(*read)(uint32_t offset);
+    // Apaga os setores cobertos e grava (offset alinhado a OTA_SECTOR_SIZE, data na RAM)
+    bool (*erase_program)(uint32_t offset, const uint8_t *data, uint32_t len);
+    // Grava páginas sem apagar (offset alinhado a OTA_PAGE_SIZE)
+    bool (*program)(uint32_t offset, const uint8_t *data, uint32_t len);
+    uint32_t control;       // Setor do ota_control_t
+    uint32_t journal;       // Setor do diário da troca
+    uint32_t scratch;       // Setor de rascunho da troca
+} ota_flash_t;
+
+// Gravação em fluxo: o corpo chega em partes e só um setor fica em RAM
+typedef struct {
+    const ota_flash_t *flash;
+    uint32_t base;          // Início do slot de destino
+    uint32_t size;          // Tamanho anunciado da imagem
+    uint32_t received;
+    uint32_t fill;          // Bytes no buffer do setor atual
+    bool failed;
+    sha256_t hash;          // Calculado à medida que os dados chegam
+    uint8_t sector[OTA_SECTOR_SIZE];
+} ota_writer_t;
+
+extern void ota_writer_begin(ota_writer_t *writer, const ota_flash_t *flash, uint32_t base, uint32_t size);
+
+// Acumula os dados e grava cada setor completo, relendo-o da flash; false se exceder o tamanho,
+// a gravação falhar ou o setor relido divergir
+extern bool ota_writer_write(ota_writer_t *writer, const uint8_t *data, uint32_t len);
+
+// Grava o último setor (completado com 0xFF) e entrega o hash; false se faltaram bytes
+extern bool ota_writer_finish(ota_writer_t *writer, uint8_t digest[SHA256_DIGEST_SIZE]);
+
+// Relê a imagem da flash e compara com o hash esperado
+extern bool ota_image_verify(const ota_flash_t *flash, uint32_t base, uint32_t size,
+                             const uint8_t digest[SHA256_DIGEST_SIZE]);
+
+// Confere a tabela de vetores: pilha na RAM e reset dentro do slot A (onde a imagem executa)
+extern bool ota_image_plausible(const ota_flash_t *flash, uint32_t base, uint32_t size);
+
+// Lê o registro de controle; sem registro válido retorna false e preenche um registro ocioso
+extern bool ota_control_load(const ota_flash_t *flash, ota_control_t *control);
+extern bool ota_control_store(const ota_flash_t *flash, const ota_control_t *control);
+
+// Apaga o diário; deve ser chamada antes de mudar o estado para SWAP_IN
+extern bool ota_journal_reset(const ota_flash_t *flash);
+
+// Troca os primeiros size bytes dos slots A e B setor a setor, registrando cada passo no diário.
+// Chamada de novo após uma queda de energia, retoma do último passo concluído.
+extern bool ota_swap(const ota_flash_t *flash, uint32_t size);
+
+// Passos da troca concluídos segundo o diário
+extern uint32_t ota_swap_progress(const ota_flash_t *flash);
+
+// Desfaz os primeiros done passos de uma troca completa ou interrompida, com diário próprio:
+// chamada de novo com o mesmo done após uma queda de energia, retoma de onde parou.
+extern bool ota_swap_undo(const ota_flash_t *flash, uint32_t size, uint32_t done);
+
+// Máquina de estados do bootloader: confere e troca a imagem pendente, desfaz a troca que falhou
+// ou não confirmou e retoma o que uma queda de energia interrompeu. Retorna true se a imagem
+// do slot A acabou de entrar em teste (o bootloader liga o watchdog).
+extern bool ota_boot(const ota_flash_t *flash, ota_control_t *control, uint32_t (*now_us)(void));
+
+#endif
@@ -0,0 +1,82 @@
+#include <string.h>
+#include "policy.h"
+
+static const policy_tier_t policy_default_tiers[POLICY_MAX_TIERS] = {
+    // Resmungo: faixa curta e baixa, sem notificação
+    { .name = "agitado", .min_short_pct = 25, .min_long_pct = 0, .track = 1, .volume = 20, .loop = false, .notify = false },
+    // Choro sustentado: canção de ninar em loop e notificação
+    { .name = "choro", .min_short_pct = 25, .min_long_pct = 15, .track = 0, .volume = 50, .loop = true, .notify = true },
+    // Choro intenso: volume máximo
+    { .name = "intenso", .min_short_pct = 50, .min_long_pct = 40, .track = 0, .volume = 100, .loop = true, .notify = true }
+};
+
+void policy_window_init(policy_window_t *window, uint16_t long_len, uint16_t short_len) {
+    memset(window, 0, sizeof(*window));
+    window->long_len = long_len > POLICY_WINDOW_MAX ? POLICY_WINDOW_MAX : (long_len ? long_len : 1);
+    window->short_len = short_len > window->long_len ? window->long_len : (short_len ? short_len : 1);
+}
+
+void policy_window_push(policy_window_t *window, bool active, uint8_t *short_pct, uint8_t *long_pct) {
+    uint16_t oldest_short = (window->index + window->long_len - window->short_len) % window->long_len;
+
+    // Subtrai o bloco mais antigo de cada janela e adiciona o novo
+    window->long_count -= window->blocks[window->index];
+    window->short_count -= window->blocks[oldest_short];
+    window->blocks[window->index] = active ? 1 : 0;
+    window->long_count += window->blocks[window->index];
+    window->short_count += window->blocks[window->index];
+    window->index = (window->index + 1) % window->long_len;
+
+    *short_pct = window->short_count * 100 / window->short_len;
+    *long_pct = window->long_count * 100 / window->long_len;
+}
+
+uint8_t policy_window_long_pct(const policy_window_t *window) {
+    return window->long_count * 100 / window->long_len;
+}
+
+void policy_init(policy_t *policy) {
+    memset(policy, 0, sizeof(*policy));
+    memcpy(policy->tiers, policy_default_tiers, sizeof(policy->tiers));
+    policy->quiet_ms = POLICY_QUIET_MS;
+    policy->quiet_pct = POLICY_QUIET_PCT;
+}
+
+void policy_reset(policy_t *policy) {
+    policy->level = 0;
+    policy->quiet = false;
+}
+
+policy_action_t policy_update(policy_t *policy, uint8_t short_pct, uint8_t long_pct, uint32_t now_ms) {
+    policy_action_t action = { .type = POLICY_ACTION_NONE, .tier = NULL, .level = 0 };
+
+    // Nível mais intenso atendido pelas duas janelas
+    uint8_t target = 0;
+    for (uint8_t i = 0; i < POLICY_MAX_TIERS; i++) {
+        const policy_tier_t *tier = &policy->tiers[i];
+        if (short_pct >= tier->min_short_pct && long_pct >= tier->min_long_pct) {
+            target = i + 1;
+        }
+    }
+
+    // Contagem do silêncio na janela curta
+    if (short_pct <= policy->quiet_pct) {
+        if (!policy->quiet) {
+            policy->quiet = true;
+            policy->quiet_since_ms = now_ms;
+        }
+    } else {
+        policy->quiet = false;
+    }
+
+    if (target > policy->level) {
+        policy->level = target;
+        action.type = POLICY_ACTION_PLAY;
+        action.tier = &policy->tiers[target - 1];
+        action.level = target;
+    } else if (policy->level > 0 && policy->quiet && now_ms - policy->quiet_since_ms >= policy->quiet_ms) {
+        policy->level = 0;
+        action.type = POLICY_ACTION_FADE;
+    }
+    return action;
+}
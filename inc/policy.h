@@ -0,0 +1,75 @@
+#ifndef policy_inc_h
+#define policy_inc_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define POLICY_MAX_TIERS 3            // Níveis de resposta além do repouso
+#define POLICY_QUIET_MS 20000         // Silêncio necessário para encerrar a resposta
+#define POLICY_QUIET_PCT 5            // Atividade na janela curta ainda tratada como silêncio (ruído residual)
+#define POLICY_WINDOW_MAX 200         // Blocos na janela longa
+
+// Nível de resposta: ativado quando as duas janelas de atividade atingem os mínimos
+typedef struct {
+    const char *name;
+    uint8_t min_short_pct;  // Atividade mínima na janela curta (%)
+    uint8_t min_long_pct;   // Atividade mínima na janela longa (%)
+    uint8_t track;          // Índice em song_library_get (embutidas na ordem de SONG_SOURCES, depois os slots)
+    uint8_t volume;         // 0 a 100
+    bool loop;              // Repete a faixa até o silêncio
+    bool notify;            // Envia notificação ao entrar no nível
+} policy_tier_t;
+
+typedef enum {
+    POLICY_ACTION_NONE = 0,
+    POLICY_ACTION_PLAY,     // Toca (ou troca para) a faixa do nível com o volume indicado
+    POLICY_ACTION_FADE      // Silêncio por quiet_ms: diminui o volume até parar
+} policy_action_type_t;
+
+typedef struct {
+    policy_action_type_t type;
+    const policy_tier_t *tier;  // Nível que originou a ação (PLAY)
+    uint8_t level;              // 1 a POLICY_MAX_TIERS (PLAY)
+} policy_action_t;
+
+// Motor de regras puro: recebe a atividade e o tempo atual, sem acesso ao hardware
+typedef struct {
+    policy_tier_t tiers[POLICY_MAX_TIERS];  // Ordenados do mais brando ao mais intenso
+    uint32_t quiet_ms;
+    uint8_t quiet_pct;      // Silêncio: atividade na janela curta até este valor
+    uint8_t level;          // 0 = repouso
+    bool quiet;
+    uint32_t quiet_since_ms;
+} policy_t;
+
+// Janelas de atividade: a curta é o final da longa, no mesmo buffer circular de blocos
+typedef struct {
+    uint8_t blocks[POLICY_WINDOW_MAX];  // 1 = bloco acima do limiar
+    uint16_t long_len;
+    uint16_t short_len;
+    uint16_t index;
+    uint16_t long_count;
+    uint16_t short_count;
+} policy_window_t;
+
+// long_len até POLICY_WINDOW_MAX blocos; short_len até long_len
+extern void policy_window_init(policy_window_t *window, uint16_t long_len, uint16_t short_len);
+
+// Acrescenta um bloco (descartando o mais antigo de cada janela) e retorna a atividade em %
+extern void policy_window_push(policy_window_t *window, bool active, uint8_t *short_pct, uint8_t *long_pct);
+
+// Atividade da janela longa em % sem acrescentar bloco
+extern uint8_t policy_window_long_pct(const policy_window_t *window);
+
+// Carrega os níveis padrão
+extern void policy_init(policy_t *policy);
+
+// Volta ao repouso (ex.: melodia interrompida pelo usuário)
+extern void policy_reset(policy_t *policy);
+
+// Avalia a atividade atual; custo constante (no máximo POLICY_MAX_TIERS comparações).
+// O nível só sobe enquanto houver atividade e só volta ao repouso após quiet_ms com a janela curta
+// em no máximo quiet_pct (o cancelamento do tom e o ruído deixam blocos isolados acima do limiar).
+extern policy_action_t policy_update(policy_t *policy, uint8_t short_pct, uint8_t long_pct, uint32_t now_ms);
+
+#endif
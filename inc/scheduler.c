@@ -0,0 +1,136 @@
+#include <string.h>
+#include "scheduler.h"
+
+void sched_init(scheduler_t *sched, sched_clock_fn clock) {
+    memset(sched, 0, sizeof(*sched));
+    sched->clock = clock;
+}
+
+static int sched_add(scheduler_t *sched, const char *name, uint32_t delay_us, uint32_t period_us,
+                     uint8_t priority, sched_task_fn fn, void *ctx) {
+    // Preferência: posição inativa com o mesmo nome (mantém a contabilidade), depois uma
+    // nunca usada e, por fim, qualquer posição inativa (one-shot concluída ou cancelada)
+    int slot = -1;
+    int unused = -1;
+    int inactive = -1;
+    for (int i = 0; i < SCHED_MAX_TASKS; i++) {
+        sched_task_t *task = &sched->tasks[i];
+        if (task->active) {
+            continue;
+        }
+        if (task->name == NULL) {
+            if (unused < 0) {
+                unused = i;
+            }
+        } else if (strcmp(task->name, name) == 0) {
+            slot = i;
+            break;
+        } else if (inactive < 0) {
+            inactive = i;
+        }
+    }
+    if (slot < 0) {
+        slot = unused >= 0 ? unused : inactive;
+    }
+    if (slot < 0) {
+        return -1;
+    }
+
+    sched_task_t *task = &sched->tasks[slot];
+    if (task->name == NULL || strcmp(task->name, name) != 0) {
+        memset(task, 0, sizeof(*task));
+    }
+    task->name = name;
+    task->fn = fn;
+    task->ctx = ctx;
+    task->period_us = period_us;
+    task->priority = priority;
+    task->next_run_us = sched->clock() + delay_us;
+    task->active = true;
+    return slot;
+}
+
+int sched_add_periodic(scheduler_t *sched, const char *name, uint32_t period_ms, uint8_t priority,
+                       sched_task_fn fn, void *ctx) {
+    return sched_add(sched, name, period_ms * 1000, period_ms * 1000, priority, fn, ctx);
+}
+
+int sched_add_oneshot(scheduler_t *sched, const char *name, uint32_t delay_ms, uint8_t priority,
+                      sched_task_fn fn, void *ctx) {
+    return sched_add(sched, name, delay_ms * 1000, 0, priority, fn, ctx);
+}
+
+void sched_cancel(scheduler_t *sched, int id) {
+    if (id >= 0 && id < SCHED_MAX_TASKS) {
+        sched->tasks[id].active = false;
+    }
+}
+
+bool sched_run_next(scheduler_t *sched) {
+    uint64_t now = sched->clock();
+
+    sched_task_t *ready = NULL;
+    for (int i = 0; i < SCHED_MAX_TASKS; i++) {
+        sched_task_t *task = &sched->tasks[i];
+        if (!task->active || task->next_run_us > now) {
+            continue;
+        }
+        if (ready == NULL || task->priority > ready->priority ||
+            (task->priority == ready->priority && task->next_run_us < ready->next_run_us)) {
+            ready = task;
+        }
+    }
+    if (ready == NULL) {
+        return false;
+    }
+
+    uint64_t deadline = ready->next_run_us;
+    uint32_t late = now - deadline;
+    if (late > ready->max_late_us) {
+        ready->max_late_us = late;
+    }
+
+    // Agenda a próxima ativação antes de executar: a tarefa pode se cancelar ou,
+    // sendo única, reagendar-se na mesma posição
+    if (ready->period_us == 0) {
+        ready->active = false;
+    } else {
+        ready->next_run_us = deadline + ready->period_us;
+        if (ready->next_run_us <= now) {
+            // Ativações perdidas são descartadas em vez de executadas em rajada
+            ready->overruns++;
+            ready->next_run_us = now + ready->period_us;
+        }
+    }
+
+    ready->fn(ready->ctx);
+
+    uint32_t elapsed = sched->clock() - now;
+    ready->runs++;
+    ready->total_us += elapsed;
+    if (elapsed > ready->max_us) {
+        ready->max_us = elapsed;
+    }
+    if (ready->period_us != 0 && elapsed > ready->period_us) {
+        ready->overruns++;
+    }
+    return true;
+}
+
+uint64_t sched_next_deadline(const scheduler_t *sched) {
+    uint64_t deadline = SCHED_NO_DEADLINE;
+    for (int i = 0; i < SCHED_MAX_TASKS; i++) {
+        const sched_task_t *task = &sched->tasks[i];
+        if (task->active && task->next_run_us < deadline) {
+            deadline = task->next_run_us;
+        }
+    }
+    return deadline;
+}
+
+const sched_task_t *sched_get_task(const scheduler_t *sched, int id) {
+    if (id < 0 || id >= SCHED_MAX_TASKS || sched->tasks[id].name == NULL) {
+        return NULL;
+    }
+    return &sched->tasks[id];
+}
@@ -0,0 +1,58 @@
+#ifndef scheduler_inc_h
+#define scheduler_inc_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SCHED_MAX_TASKS 12
+#define SCHED_NO_DEADLINE UINT64_MAX
+
+typedef void (*sched_task_fn)(void *ctx);
+
+// Relógio em microssegundos; no dispositivo é time_us_64(), mas qualquer relógio
+// (inclusive um relógio virtual) pode ser usado
+typedef uint64_t (*sched_clock_fn)(void);
+
+typedef struct {
+    const char *name;       // NULL = posição livre
+    sched_task_fn fn;
+    void *ctx;
+    uint64_t next_run_us;
+    uint32_t period_us;     // 0 = tarefa única (one-shot)
+    uint8_t priority;       // Maior valor executa primeiro quando várias estão prontas
+    bool active;
+
+    // Contabilidade de execução
+    uint32_t runs;
+    uint32_t overruns;      // Ativações perdidas ou execução mais longa que o período
+    uint64_t total_us;
+    uint32_t max_us;
+    uint32_t max_late_us;   // Maior atraso entre o prazo e o início da execução
+} sched_task_t;
+
+typedef struct {
+    sched_task_t tasks[SCHED_MAX_TASKS];
+    sched_clock_fn clock;
+} scheduler_t;
+
+extern void sched_init(scheduler_t *sched, sched_clock_fn clock);
+
+// Retornam o identificador da tarefa ou -1 se não houver posição livre
+extern int sched_add_periodic(scheduler_t *sched, const char *name, uint32_t period_ms, uint8_t priority,
+                              sched_task_fn fn, void *ctx);
+extern int sched_add_oneshot(scheduler_t *sched, const char *name, uint32_t delay_ms, uint8_t priority,
+                             sched_task_fn fn, void *ctx);
+
+extern void sched_cancel(scheduler_t *sched, int id);
+
+// Executa a tarefa pronta de maior prioridade (empate: prazo mais antigo).
+// Retorna false se nenhuma tarefa estava pronta.
+extern bool sched_run_next(scheduler_t *sched);
+
+// Prazo mais próximo entre as tarefas ativas (SCHED_NO_DEADLINE se não houver)
+extern uint64_t sched_next_deadline(const scheduler_t *sched);
+
+// Tarefa na posição id (NULL se a posição nunca foi usada)
+extern const sched_task_t *sched_get_task(const scheduler_t *sched, int id);
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef sha256_inc_h
+#define sha256_inc_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHA256_BLOCK_SIZE 64
+#define SHA256_DIGEST_SIZE 32
+
+typedef struct {
+    uint32_t state[8];
+    uint64_t length;                  // Bytes processados
+    uint8_t block[SHA256_BLOCK_SIZE];
+    uint8_t block_len;
+} sha256_t;
+
+extern void sha256_init(sha256_t *ctx);
+extern void sha256_update(sha256_t *ctx, const void *data, size_t len);
+extern void sha256_final(sha256_t *ctx, uint8_t digest[SHA256_DIGEST_SIZE]);
+
+// Atalho para uma única mensagem
+extern void sha256(const void *data, size_t len, uint8_t digest[SHA256_DIGEST_SIZE]);
+
+#endif
@@ -0,0 +1,95 @@
+#include <string.h>
+#include "song.h"
+#include "flash_store.h"
+
+// Frequências da oitava MIDI 9 (notas 108 a 119); as demais são obtidas por deslocamento
+static const uint16_t song_top_octave[12] = {
+    4186, 4435, 4699, 4978, 5274, 5588, 5920, 6272, 6645, 7040, 7459, 7902
+};
+
+static uint song_midi_frequency(uint8_t midi) {
+    if (midi == 0) {
+        return 0;
+    }
+    uint octave = midi / 12;
+    uint frequency = song_top_octave[midi % 12];
+    if (octave >= 9) {
+        return frequency << (octave - 9);
+    }
+    uint shift = 9 - octave;
+    return (frequency + (1u << (shift - 1))) >> shift;  // Arredonda
+}
+
+bool song_validate(const uint8_t *data, uint32_t size) {
+    if (size < SONG_HEADER_SIZE || data[0] != SONG_MAGIC_0 || data[1] != SONG_MAGIC_1 ||
+        data[2] != SONG_VERSION || data[3] == 0 || data[5] > 100) {
+        return false;
+    }
+    if (memchr(data + 8, '\0', SONG_NAME_MAX) == NULL) {
+        return false;
+    }
+    uint count = song_note_count(data);
+    if (count == 0 || SONG_HEADER_SIZE + 2 * count > size) {
+        return false;
+    }
+    for (uint i = 0; i < count; i++) {
+        uint8_t midi = data[SONG_HEADER_SIZE + 2 * i];
+        if (midi != 0 && (midi < SONG_MIDI_MIN || midi > SONG_MIDI_MAX)) {
+            return false;
+        }
+        if ((data[SONG_HEADER_SIZE + 2 * i + 1] & 0x07) > SONG_MAX_DURATION_CODE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void song_get_note(const uint8_t *song, uint index, song_note_t *note) {
+    const uint8_t *packed = song + SONG_HEADER_SIZE + 2 * index;
+    uint8_t code = packed[1];
+
+    // Semibreve = 4 tempos; cada figura seguinte dura a metade
+    uint duration = (240000u / song[3]) >> (code & 0x07);
+    if (code & SONG_DOTTED) {
+        duration += duration / 2;
+    }
+
+    note->frequency = song_midi_frequency(packed[0]);
+    note->duration_ms = duration;
+    note->volume = song[5] * ((code >> 4) + 1) / 16;
+}
+
+uint song_note_count(const uint8_t *song) {
+    return song[6] | (song[7] << 8);
+}
+
+uint8_t song_repeats(const uint8_t *song) {
+    return song[4];
+}
+
+const char *song_name(const uint8_t *song) {
+    return (const char *)song + 8;
+}
+
+uint song_library_count(void) {
+    return song_builtin_count + FLASH_STORE_SONG_SLOTS;
+}
+
+const uint8_t *song_library_get(uint index) {
+    if (index < song_builtin_count) {
+        return song_builtin[index];
+    }
+    index -= song_builtin_count;
+    if (index >= FLASH_STORE_SONG_SLOTS) {
+        return NULL;
+    }
+    const uint8_t *song = flash_store_read(FLASH_STORE_SONGS + index * FLASH_STORE_SONG_SLOT_SIZE);
+    return song_validate(song, FLASH_STORE_SONG_SLOT_SIZE) ? song : NULL;
+}
+
+bool song_library_store(uint slot, const uint8_t *data, uint32_t size) {
+    if (slot >= FLASH_STORE_SONG_SLOTS || size > FLASH_STORE_SONG_SLOT_SIZE) {
+        return false;
+    }
+    return flash_store_write(FLASH_STORE_SONGS + slot * FLASH_STORE_SONG_SLOT_SIZE, data, size);
+}
@@ -0,0 +1,61 @@
+#ifndef song_inc_h
+#define song_inc_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pico/stdlib.h"
+
+// Formato compacto de faixa (gerado por tools/songc.py):
+//   cabeçalho de SONG_HEADER_SIZE bytes
+//     0-1  'S' 'G'
+//     2    versão (SONG_VERSION)
+//     3    andamento (bpm, semínimas por minuto)
+//     4    repetições (tocadas por vez quando não está em loop)
+//     5    volume da faixa (0 a 100)
+//     6-7  número de notas (little endian)
+//     8-19 nome (terminado em '\0')
+//   2 bytes por nota
+//     nota MIDI (0 = pausa)
+//     bits 0-2 figura (0 semibreve ... 5 fusa), bit 3 pontuada, bits 4-7 volume (envelope, 0 a 15)
+#define SONG_MAGIC_0 'S'
+#define SONG_MAGIC_1 'G'
+#define SONG_VERSION 1
+#define SONG_HEADER_SIZE 20
+#define SONG_NAME_MAX 12
+#define SONG_MAX_DURATION_CODE 5
+
+#define SONG_DOTTED 0x08
+
+// Faixa de notas aceita: abaixo de B0 (~31 Hz) o contador de 16 bits do PWM do buzzer
+// estoura com MELODY_PWM_CLKDIV 64 (mesmos limites em tools/songc.py)
+#define SONG_MIDI_MIN 23
+#define SONG_MIDI_MAX 127
+
+typedef struct {
+    uint frequency;     // Hz (0 = pausa)
+    uint duration_ms;
+    uint8_t volume;     // 0 a 100, já com o volume da faixa aplicado
+} song_note_t;
+
+// Faixas embutidas no firmware (song_library.c, gerado a partir de songs/*.txt)
+extern const uint8_t *const song_builtin[];
+extern const uint song_builtin_count;
+
+// Verifica cabeçalho e notas (figura e faixa MIDI) de uma faixa com até size bytes
+extern bool song_validate(const uint8_t *data, uint32_t size);
+
+// Decodifica a nota index diretamente da faixa (na flash), sem cópia
+extern void song_get_note(const uint8_t *song, uint index, song_note_t *note);
+
+extern uint song_note_count(const uint8_t *song);
+extern uint8_t song_repeats(const uint8_t *song);
+extern const char *song_name(const uint8_t *song);
+
+// Biblioteca: faixas embutidas seguidas pelos slots da flash. Retorna NULL para slot vazio.
+extern uint song_library_count(void);
+extern const uint8_t *song_library_get(uint index);
+
+// Grava uma faixa num slot da flash (data na RAM, já validada)
+extern bool song_library_store(uint slot, const uint8_t *data, uint32_t size);
+
+#endif
@@ -37,4 +37,7 @@ static uint8_t font[] = {
     0x01, 0x01, 0x01, 0x61, 0x31, 0x0d, 0x03, 0x00, // 7
     0x36, 0x49, 0x49, 0x49, 0x49, 0x49, 0x36, 0x00, // 8
     0x06, 0x09, 0x09, 0x09, 0x09, 0x09, 0x7f, 0x00, // 9
+    0x00, 0x00, 0x60, 0x60, 0x00, 0x00, 0x00, 0x00, // .
+    0x00, 0x00, 0x36, 0x36, 0x00, 0x00, 0x00, 0x00, // :
+    0x43, 0x23, 0x10, 0x08, 0x04, 0x62, 0x61, 0x00, // %
 };
\ No newline at end of file
@@ -26,16 +26,20 @@ void ssd1306_send_command_list(uint8_t *ssd, int number) {
     }
 }
 
-// Copia buffer de referência num novo buffer, a fim de adicionar o byte de controle desde o início
-void ssd1306_send_buffer(uint8_t ssd[], int buffer_length) {
-    uint8_t *temp_buffer = malloc(buffer_length + 1);
+// Buffer estático de envio (byte de controle + quadro completo), evita alocação a cada quadro
+static uint8_t ssd1306_tx_buffer[ssd1306_buffer_length + 1];
+
+// Buffer do modo bitmap, reservado estaticamente para a maior tela suportada
+static uint8_t ssd1306_bm_buffer[ssd1306_buffer_length + 1];
 
-    temp_buffer[0] = 0x40;
-    memcpy(temp_buffer + 1, ssd, buffer_length);
+// Copia buffer de referência no buffer de envio, a fim de adicionar o byte de controle desde o início
+void ssd1306_send_buffer(uint8_t ssd[], int buffer_length) {
+    assert(buffer_length <= (int)ssd1306_buffer_length);
 
-    i2c_write_blocking(i2c1, ssd1306_i2c_address, temp_buffer, buffer_length + 1, false);
+    ssd1306_tx_buffer[0] = 0x40;
+    memcpy(ssd1306_tx_buffer + 1, ssd, buffer_length);
 
-    free(temp_buffer);
+    i2c_write_blocking(i2c1, ssd1306_i2c_address, ssd1306_tx_buffer, buffer_length + 1, false);
 }
 
 // Cria a lista de comandos (com base nos endereços definidos em ssd1306_i2c.h) para a inicialização do display
@@ -141,6 +145,15 @@ inline int ssd1306_get_font(uint8_t character)
   else if (character >= '0' && character <= '9') {
     return character - '0' + 27;
   }
+  else if (character == '.') {
+    return 37;
+  }
+  else if (character == ':') {
+    return 38;
+  }
+  else if (character == '%') {
+    return 39;
+  }
   else
     return 0;
 }
@@ -218,7 +231,9 @@ void ssd1306_init_bm(ssd1306_t *ssd, uint8_t width, uint8_t height, bool externa
     ssd->address = address;
     ssd->i2c_port = i2c;
     ssd->bufsize = ssd->pages * ssd->width + 1;
-    ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+    assert(ssd->bufsize <= sizeof(ssd1306_bm_buffer));
+    memset(ssd1306_bm_buffer, 0, sizeof(ssd1306_bm_buffer));
+    ssd->ram_buffer = ssd1306_bm_buffer;
     ssd->ram_buffer[0] = 0x40;
     ssd->port_buffer[0] = 0x80;
 }
@@ -237,7 +252,7 @@ void ssd1306_send_data(ssd1306_t *ssd) {
 
 // Desenha o bitmap (a ser fornecido em display_oled.c) no display
 void ssd1306_draw_bitmap(ssd1306_t *ssd, const uint8_t *bitmap) {
-    for (int i = 0; i < ssd->bufsize - 1; i++) {
+    for (size_t i = 0; i < ssd->bufsize - 1; i++) {
         ssd->ram_buffer[i + 1] = bitmap[i];
 
         ssd1306_send_data(ssd);
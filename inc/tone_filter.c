@@ -0,0 +1,199 @@
+#include <math.h>
+#include <stdbool.h>
+#include "tone_filter.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define TONE_FILTER_COMPONENTS (TONE_FILTER_MAX_TONES * TONE_FILTER_HARMONICS)
+#define TONE_FILTER_BASIS (2 * TONE_FILTER_COMPONENTS)  // Cosseno e seno de cada componente
+
+static float block[TONE_FILTER_BLOCK_MAX];
+
+// Base do último conjunto de tons: refeita só quando a nota (ou o bloco) muda
+static struct {
+    uint32_t tones[TONE_FILTER_MAX_TONES];
+    uint32_t count;
+    float sample_rate;
+    uint32_t components;
+    float step[TONE_FILTER_COMPONENTS];             // Frequência angular por amostra
+    float chol[TONE_FILTER_BASIS][TONE_FILTER_BASIS]; // Cholesky da matriz de Gram
+    bool used[TONE_FILTER_BASIS];                   // false = dependente das anteriores
+    uint32_t rank;
+} basis;
+
+// Somas de cos(theta n) e sin(theta n) para n = 0..count-1, em forma fechada
+static void sum_cos_sin(float theta, uint32_t count, float *sum_cos, float *sum_sin) {
+    float half = sinf(theta / 2);
+    if (fabsf(half) < 1e-6f) {
+        *sum_cos = count;  // theta múltiplo de 2 pi
+        *sum_sin = 0.0f;
+        return;
+    }
+    float ratio = sinf(count * theta / 2) / half;
+    *sum_cos = ratio * cosf((count - 1) * theta / 2);
+    *sum_sin = ratio * sinf((count - 1) * theta / 2);
+}
+
+// Lista as componentes (tom e harmônicos, rebatidos abaixo de Nyquist) e fatora a matriz de Gram
+static void build_basis(float sample_rate, uint32_t count) {
+    float resolution = sample_rate / count;
+    basis.components = 0;
+    for (uint32_t t = 0; t < TONE_FILTER_MAX_TONES; t++) {
+        for (uint32_t h = 0; basis.tones[t] != 0 && h < TONE_FILTER_HARMONICS; h++) {
+            // Sem filtro anti-aliasing no ADC os harmônicos acima de Nyquist aparecem rebatidos
+            float frequency = fmodf(basis.tones[t] * (h + 1), sample_rate);
+            if (frequency > sample_rate / 2) {
+                frequency = sample_rate - frequency;
+            }
+            if (frequency < 1.0f || frequency > sample_rate / 2 - 1.0f) {
+                continue;  // DC e Nyquist já tratados pela média
+            }
+            // Rebatidos a menos de meia resolução de outra componente não têm como ser separados dela
+            float step = 2.0f * (float)M_PI * frequency / sample_rate;
+            uint32_t k = 0;
+            while (k < basis.components && fabsf(basis.step[k] - step) >= (float)M_PI * resolution / sample_rate) {
+                k++;
+            }
+            if (k == basis.components) {
+                basis.step[basis.components++] = step;
+            }
+        }
+    }
+
+    // Matriz de Gram (triângulo inferior) das referências cosseno/seno sem DC, pois o bloco
+    // também está sem DC: um par de somas em forma fechada por par de componentes
+    float mean_cos[TONE_FILTER_COMPONENTS], mean_sin[TONE_FILTER_COMPONENTS];
+    for (uint32_t k = 0; k < basis.components; k++) {
+        sum_cos_sin(basis.step[k], count, &mean_cos[k], &mean_sin[k]);
+        mean_cos[k] /= count;
+        mean_sin[k] /= count;
+    }
+    float (*gram)[TONE_FILTER_BASIS] = basis.chol;
+    for (uint32_t i = 0; i < basis.components; i++) {
+        for (uint32_t j = 0; j <= i; j++) {
+            float cd, sd, cs, ss;
+            sum_cos_sin(basis.step[i] - basis.step[j], count, &cd, &sd);
+            sum_cos_sin(basis.step[i] + basis.step[j], count, &cs, &ss);
+            gram[2 * i][2 * j] = (cd + cs) / 2 - count * mean_cos[i] * mean_cos[j];
+            gram[2 * i + 1][2 * j + 1] = (cd - cs) / 2 - count * mean_sin[i] * mean_sin[j];
+            gram[2 * i + 1][2 * j] = (ss + sd) / 2 - count * mean_sin[i] * mean_cos[j];
+            gram[2 * i][2 * j + 1] = (ss - sd) / 2 - count * mean_cos[i] * mean_sin[j];
+        }
+    }
+
+    // Cholesky no lugar; um vetor quase dependente dos anteriores é descartado
+    uint32_t size = 2 * basis.components;
+    basis.rank = 0;
+    for (uint32_t j = 0; j < size; j++) {
+        float diagonal = gram[j][j];
+        float d = diagonal;
+        for (uint32_t k = 0; k < j; k++) {
+            d -= basis.chol[j][k] * basis.chol[j][k];
+        }
+        basis.used[j] = d > 1e-3f * diagonal && d > 1e-6f;
+        if (!basis.used[j]) {
+            for (uint32_t i = j; i < size; i++) {
+                basis.chol[i][j] = 0.0f;
+            }
+            continue;
+        }
+        basis.rank++;
+        basis.chol[j][j] = sqrtf(d);
+        for (uint32_t i = j + 1; i < size; i++) {
+            float value = gram[i][j];
+            for (uint32_t k = 0; k < j; k++) {
+                value -= basis.chol[i][k] * basis.chol[j][k];
+            }
+            basis.chol[i][j] = value / basis.chol[j][j];
+        }
+    }
+}
+
+float tone_filter_residual_level(const uint16_t *samples, uint32_t count, float sample_rate,
+                                 const uint32_t *tones, uint32_t tone_count, float volts_per_count) {
+    if (count > TONE_FILTER_BLOCK_MAX) {
+        count = TONE_FILTER_BLOCK_MAX;
+    }
+    if (count == 0) {
+        return 0.0f;
+    }
+
+    uint32_t wanted[TONE_FILTER_MAX_TONES] = { 0 };
+    for (uint32_t t = 0; t < tone_count && t < TONE_FILTER_MAX_TONES; t++) {
+        wanted[t] = (t > 0 && tones[t] == tones[0]) ? 0 : tones[t];
+    }
+    bool changed = basis.count != count || basis.sample_rate != sample_rate;
+    for (uint32_t t = 0; t < TONE_FILTER_MAX_TONES; t++) {
+        changed |= basis.tones[t] != wanted[t];
+        basis.tones[t] = wanted[t];
+    }
+    if (changed) {
+        basis.count = count;
+        basis.sample_rate = sample_rate;
+        build_basis(sample_rate, count);
+    }
+
+    // Remove o nível DC (substitui o offset fixo do microfone)
+    float mean = 0.0f;
+    for (uint32_t i = 0; i < count; i++) {
+        mean += samples[i];
+    }
+    mean /= count;
+    float energy = 0.0f;
+    for (uint32_t i = 0; i < count; i++) {
+        block[i] = (samples[i] - mean) * volts_per_count;
+        energy += block[i] * block[i];
+    }
+
+    // Ajuste conjunto por mínimos quadrados de todas as componentes: as correlações do bloco com
+    // as referências saem de um Goertzel por componente (uma multiplicação por amostra) e a
+    // energia explicada pelo ajuste é |L^-1 x|^2, sem gerar as senoides nem subtraí-las do bloco
+    float solved[TONE_FILTER_BASIS];
+    float explained = 0.0f;
+    for (uint32_t k = 0; k < basis.components; k++) {
+        float step = basis.step[k];
+        float cos_step = cosf(step), sin_step = sinf(step);
+        float coeff = 2.0f * cos_step;
+        float s1 = 0.0f, s2 = 0.0f;
+        for (uint32_t i = 0; i < count; i++) {
+            float s0 = block[i] + coeff * s1 - s2;
+            s2 = s1;
+            s1 = s0;
+        }
+        float zr = s1 - cos_step * s2;
+        float zi = sin_step * s2;
+        float phase = step * (count - 1);
+        float cos_phase = cosf(phase), sin_phase = sinf(phase);
+        float correlation[2] = {
+            cos_phase * zr + sin_phase * zi,  // Soma de x[n] cos(step n)
+            sin_phase * zr - cos_phase * zi   // Soma de x[n] sin(step n)
+        };
+
+        for (uint32_t j = 2 * k; j < 2 * k + 2; j++) {
+            solved[j] = 0.0f;
+            if (!basis.used[j]) {
+                continue;
+            }
+            float value = correlation[j & 1];
+            for (uint32_t m = 0; m < j; m++) {
+                value -= basis.chol[j][m] * solved[m];
+            }
+            solved[j] = value / basis.chol[j][j];
+            explained += solved[j] * solved[j];
+        }
+    }
+    energy -= explained;
+    if (energy < 0.0f) {
+        energy = 0.0f;
+    }
+
+    // Cada vetor da base leva um grau de liberdade do resíduo (e a média mais um): a energia é
+    // dividida pelos que sobram, para que o nível do ruído não dependa do tom tocando
+    int32_t freedom = (int32_t)count - 1 - (int32_t)basis.rank;
+    if (freedom < 1) {
+        freedom = 1;
+    }
+    return sqrtf(2.0f * energy / freedom);
+}
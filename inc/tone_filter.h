@@ -0,0 +1,19 @@
+#ifndef tone_filter_inc_h
+#define tone_filter_inc_h
+
+#include <stdint.h>
+
+#define TONE_FILTER_BLOCK_MAX 512     // Maior bloco aceito
+#define TONE_FILTER_MAX_TONES 2       // Tons distintos num mesmo bloco (troca de nota durante a captura)
+#define TONE_FILTER_HARMONICS 8       // Harmônicos removidos (1f a 8f): com duty abaixo de 50% surgem também os pares
+
+// Nível do bloco com o tom do buzzer cancelado por correlação com uma referência:
+// para cada tom (e harmônico, rebatido abaixo de Nyquist) ajusta por mínimos quadrados a senoide de mesma
+// frequência presente no bloco e a subtrai. Retorna a amplitude equivalente
+// (sqrt(2) x RMS) do sinal residual, em volts, corrigida pelos graus de liberdade removidos:
+// para o mesmo ruído o nível não muda com o número de componentes canceladas.
+// tones: frequências em Hz emitidas durante o bloco (0 = ignorado).
+extern float tone_filter_residual_level(const uint16_t *samples, uint32_t count, float sample_rate,
+                                        const uint32_t *tones, uint32_t tone_count, float volts_per_count);
+
+#endif
@@ -0,0 +1,299 @@
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "ssd1306.h"
+#include "ui.h"
+
+typedef enum {
+    UI_WIDGET_LABEL = 1,
+    UI_WIDGET_BAR,
+    UI_WIDGET_SPARKLINE,
+    UI_WIDGET_ICON
+} ui_widget_type_t;
+
+typedef struct {
+    uint8_t type;       // 0 = posição livre
+    uint8_t screen;
+    uint8_t x, y, width, height;
+    union {
+        char text[UI_LABEL_MAX + 1];
+        uint8_t value;
+        ui_icon_t icon;
+        uint8_t spark;  // Índice do histórico em ui_spark
+    };
+} ui_widget_t;
+
+typedef struct {
+    uint8_t points[UI_SPARK_MAX];
+    uint8_t head;       // Próxima posição a escrever
+    uint8_t count;
+} ui_spark_t;
+
+// Ícones 8x8 no mesmo formato da fonte (uma coluna por byte, bit 0 no topo)
+static const uint8_t ui_icons[UI_ICON_COUNT][8] = {
+    [UI_ICON_WIFI] = { 0x08, 0x04, 0x12, 0xCA, 0xCA, 0x12, 0x04, 0x08 },
+    [UI_ICON_MUTE] = { 0x21, 0x3E, 0x26, 0x6B, 0x3E, 0x30, 0x40, 0x80 },
+    [UI_ICON_NOTE] = { 0x40, 0xE0, 0xE0, 0x7F, 0x41, 0xE1, 0xFF, 0x40 },
+    [UI_ICON_ALERT] = { 0xE0, 0x98, 0x86, 0xDB, 0xDB, 0x86, 0x98, 0xE0 },
+    [UI_ICON_MOON] = { 0x3C, 0x7E, 0xC3, 0x81, 0x81, 0x80, 0x40, 0x60 }
+};
+
+static ui_widget_t ui_widgets[UI_MAX_WIDGETS];
+static ui_spark_t ui_spark[UI_MAX_SPARKLINES];
+static uint8_t ui_spark_used = 0;
+static uint8_t ui_screen = 0;
+static bool ui_dirty = true;
+static uint32_t ui_last_frame_ms = 0;
+static uint32_t ui_sent_bytes = 0;
+
+static uint8_t ui_frame[ssd1306_buffer_length];  // Quadro sendo composto
+static uint8_t ui_shown[ssd1306_buffer_length];  // Último quadro enviado ao display
+
+void ui_init(void) {
+    memset(ui_widgets, 0, sizeof(ui_widgets));
+    memset(ui_spark, 0, sizeof(ui_spark));
+    ui_spark_used = 0;
+    ui_screen = 0;
+    ui_last_frame_ms = (uint32_t)-UI_FRAME_MS;  // Libera o primeiro quadro imediatamente
+
+    // Limpa o display por inteiro uma vez; depois só as diferenças são enviadas
+    struct render_area area = {
+        .start_column = 0,
+        .end_column = ssd1306_width - 1,
+        .start_page = 0,
+        .end_page = ssd1306_n_pages - 1
+    };
+    calculate_render_area_buffer_length(&area);
+    memset(ui_shown, 0, sizeof(ui_shown));
+    render_on_display(ui_shown, &area);
+    ui_dirty = true;
+}
+
+static int ui_add(uint8_t type, uint8_t screen, uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
+    for (int i = 0; i < UI_MAX_WIDGETS; i++) {
+        if (ui_widgets[i].type == 0) {
+            ui_widget_t *widget = &ui_widgets[i];
+            memset(widget, 0, sizeof(*widget));
+            widget->type = type;
+            widget->screen = screen;
+            widget->x = x;
+            widget->y = y;
+            widget->width = width;
+            widget->height = height;
+            ui_dirty = true;
+            return i;
+        }
+    }
+    return -1;
+}
+
+int ui_add_label(uint8_t screen, uint8_t x, uint8_t y) {
+    return ui_add(UI_WIDGET_LABEL, screen, x, y, 0, 8);
+}
+
+int ui_add_bar(uint8_t screen, uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
+    return ui_add(UI_WIDGET_BAR, screen, x, y, width, height);
+}
+
+int ui_add_sparkline(uint8_t screen, uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
+    if (ui_spark_used >= UI_MAX_SPARKLINES) {
+        return -1;
+    }
+    int id = ui_add(UI_WIDGET_SPARKLINE, screen, x, y, width > UI_SPARK_MAX ? UI_SPARK_MAX : width, height);
+    if (id >= 0) {
+        ui_widgets[id].spark = ui_spark_used++;
+    }
+    return id;
+}
+
+int ui_add_icon(uint8_t screen, uint8_t x, uint8_t y) {
+    return ui_add(UI_WIDGET_ICON, screen, x, y, 8, 8);
+}
+
+static ui_widget_t *ui_get(int widget, uint8_t type) {
+    if (widget < 0 || widget >= UI_MAX_WIDGETS || ui_widgets[widget].type != type) {
+        return NULL;
+    }
+    return &ui_widgets[widget];
+}
+
+void ui_set_text(int widget, const char *format, ...) {
+    ui_widget_t *label = ui_get(widget, UI_WIDGET_LABEL);
+    if (label == NULL) {
+        return;
+    }
+    char text[UI_LABEL_MAX + 1];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    if (strcmp(text, label->text) != 0) {
+        strcpy(label->text, text);
+        ui_dirty = true;
+    }
+}
+
+void ui_set_value(int widget, uint8_t percent) {
+    ui_widget_t *bar = ui_get(widget, UI_WIDGET_BAR);
+    if (bar == NULL) {
+        return;
+    }
+    if (percent > 100) {
+        percent = 100;
+    }
+    if (bar->value != percent) {
+        bar->value = percent;
+        ui_dirty = true;
+    }
+}
+
+void ui_push_sample(int widget, uint8_t percent) {
+    ui_widget_t *sparkline = ui_get(widget, UI_WIDGET_SPARKLINE);
+    if (sparkline == NULL) {
+        return;
+    }
+    ui_spark_t *spark = &ui_spark[sparkline->spark];
+    spark->points[spark->head] = percent > 100 ? 100 : percent;
+    spark->head = (spark->head + 1) % UI_SPARK_MAX;
+    if (spark->count < UI_SPARK_MAX) {
+        spark->count++;
+    }
+    ui_dirty = true;
+}
+
+void ui_set_icon(int widget, ui_icon_t icon) {
+    ui_widget_t *widget_icon = ui_get(widget, UI_WIDGET_ICON);
+    if (widget_icon != NULL && widget_icon->icon != icon && icon < UI_ICON_COUNT) {
+        widget_icon->icon = icon;
+        ui_dirty = true;
+    }
+}
+
+void ui_show(uint8_t screen) {
+    if (screen != ui_screen) {
+        ui_screen = screen;
+        ui_dirty = true;
+    }
+}
+
+uint8_t ui_current_screen(void) {
+    return ui_screen;
+}
+
+// ---------- Composição ----------
+
+static void ui_draw_rect(int x, int y, int width, int height, bool fill) {
+    for (int i = 0; i < width; i++) {
+        for (int j = 0; j < height; j++) {
+            if (fill || i == 0 || j == 0 || i == width - 1 || j == height - 1) {
+                ssd1306_set_pixel(ui_frame, x + i, y + j, true);
+            }
+        }
+    }
+}
+
+static void ui_draw_bar(const ui_widget_t *bar) {
+    ui_draw_rect(bar->x, bar->y, bar->width, bar->height, false);
+    int fill = (bar->width - 4) * bar->value / 100;
+    if (fill > 0) {
+        ui_draw_rect(bar->x + 2, bar->y + 2, fill, bar->height - 4, true);
+    }
+}
+
+// Os pontos mais recentes ficam à direita; cada ponto é ligado ao anterior
+static void ui_draw_sparkline(const ui_widget_t *sparkline) {
+    const ui_spark_t *spark = &ui_spark[sparkline->spark];
+    int count = spark->count < sparkline->width ? spark->count : sparkline->width;
+    int bottom = sparkline->y + sparkline->height - 1;
+    int prev_x = -1, prev_y = 0;
+    for (int i = 0; i < count; i++) {
+        uint8_t value = spark->points[(spark->head + UI_SPARK_MAX - count + i) % UI_SPARK_MAX];
+        int x = sparkline->x + sparkline->width - count + i;
+        int y = bottom - value * (sparkline->height - 1) / 100;
+        if (prev_x >= 0) {
+            ssd1306_draw_line(ui_frame, prev_x, prev_y, x, y, true);
+        } else {
+            ssd1306_set_pixel(ui_frame, x, y, true);
+        }
+        prev_x = x;
+        prev_y = y;
+    }
+}
+
+static void ui_draw_icon(const ui_widget_t *icon) {
+    if (icon->icon == UI_ICON_NONE || icon->x > ssd1306_width - 8) {
+        return;
+    }
+    memcpy(&ui_frame[(icon->y / 8) * ssd1306_width + icon->x], ui_icons[icon->icon], 8);
+}
+
+static void ui_compose(void) {
+    memset(ui_frame, 0, sizeof(ui_frame));
+    for (int i = 0; i < UI_MAX_WIDGETS; i++) {
+        ui_widget_t *widget = &ui_widgets[i];
+        if (widget->type == 0 || (widget->screen != ui_screen && widget->screen != UI_ALL_SCREENS)) {
+            continue;
+        }
+        switch (widget->type) {
+        case UI_WIDGET_LABEL:
+            ssd1306_draw_string(ui_frame, widget->x, widget->y, widget->text);
+            break;
+        case UI_WIDGET_BAR:
+            ui_draw_bar(widget);
+            break;
+        case UI_WIDGET_SPARKLINE:
+            ui_draw_sparkline(widget);
+            break;
+        case UI_WIDGET_ICON:
+            ui_draw_icon(widget);
+            break;
+        }
+    }
+}
+
+// Envia, em cada página, só o intervalo de colunas que mudou desde o último quadro
+static bool ui_flush(void) {
+    bool sent = false;
+    for (unsigned page = 0; page < ssd1306_n_pages; page++) {
+        const uint8_t *frame = &ui_frame[page * ssd1306_width];
+        uint8_t *shown = &ui_shown[page * ssd1306_width];
+        int first = 0, last = ssd1306_width - 1;
+        while (first < ssd1306_width && frame[first] == shown[first]) {
+            first++;
+        }
+        if (first == ssd1306_width) {
+            continue;
+        }
+        while (frame[last] == shown[last]) {
+            last--;
+        }
+
+        struct render_area area = {
+            .start_column = first,
+            .end_column = last,
+            .start_page = page,
+            .end_page = page
+        };
+        calculate_render_area_buffer_length(&area);
+        memcpy(&shown[first], &frame[first], last - first + 1);
+        render_on_display(&shown[first], &area);
+        ui_sent_bytes += area.buffer_length;
+        sent = true;
+    }
+    return sent;
+}
+
+bool ui_render(uint32_t now_ms) {
+    if (!ui_dirty || now_ms - ui_last_frame_ms < UI_FRAME_MS) {
+        return false;
+    }
+    ui_last_frame_ms = now_ms;
+    ui_dirty = false;
+    ui_compose();
+    return ui_flush();
+}
+
+uint32_t ui_bytes_sent(void) {
+    return ui_sent_bytes;
+}
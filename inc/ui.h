@@ -0,0 +1,50 @@
+#ifndef ui_inc_h
+#define ui_inc_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define UI_MAX_WIDGETS 16
+#define UI_MAX_SPARKLINES 2
+#define UI_LABEL_MAX 16           // Caracteres por rótulo (uma linha inteira do display)
+#define UI_SPARK_MAX 128          // Pontos guardados por sparkline
+#define UI_FRAME_MS 100           // Intervalo mínimo entre quadros enviados (10 fps)
+#define UI_ALL_SCREENS 0xFF       // Widget presente em todas as telas (ex.: barra de status)
+
+typedef enum {
+    UI_ICON_NONE = 0,
+    UI_ICON_WIFI,
+    UI_ICON_MUTE,
+    UI_ICON_NOTE,
+    UI_ICON_ALERT,
+    UI_ICON_MOON,
+    UI_ICON_COUNT
+} ui_icon_t;
+
+// Interface retida: os widgets guardam o próprio estado e o quadro é recomposto só no
+// ui_render, que envia ao display apenas as faixas de colunas alteradas em cada página.
+// Os textos, ícones e posições usam linhas de 8 pixels (y múltiplo de 8).
+extern void ui_init(void);
+
+// Criação dos widgets (na inicialização); retornam o identificador ou -1 sem espaço
+extern int ui_add_label(uint8_t screen, uint8_t x, uint8_t y);
+extern int ui_add_bar(uint8_t screen, uint8_t x, uint8_t y, uint8_t width, uint8_t height);
+extern int ui_add_sparkline(uint8_t screen, uint8_t x, uint8_t y, uint8_t width, uint8_t height);
+extern int ui_add_icon(uint8_t screen, uint8_t x, uint8_t y);
+
+// Atualização do estado; só marcam o quadro como alterado, sem acessar o display
+extern void ui_set_text(int widget, const char *format, ...);
+extern void ui_set_value(int widget, uint8_t percent);       // Barra, 0 a 100
+extern void ui_push_sample(int widget, uint8_t percent);     // Novo ponto da sparkline
+extern void ui_set_icon(int widget, ui_icon_t icon);         // UI_ICON_NONE oculta
+extern void ui_show(uint8_t screen);
+extern uint8_t ui_current_screen(void);
+
+// Compõe e envia o quadro se houve mudança e já passou UI_FRAME_MS desde o último envio.
+// Retorna true se algo foi enviado.
+extern bool ui_render(uint32_t now_ms);
+
+// Bytes enviados ao display desde o boot (para comparar com o envio do quadro inteiro)
+extern uint32_t ui_bytes_sent(void);
+
+#endif
@@ -19,25 +19,55 @@
 #define MEM_LIBC_MALLOC             0
 #endif
 #define MEM_ALIGNMENT               4
-#define MEM_SIZE                    4000
-#define MEMP_NUM_TCP_SEG            32
+
+// Perfil de memória dimensionado para LWIP_HTTP_CLIENTS conexões simultâneas do painel
+// (deve acompanhar HTTP_MAX_CLIENTS em inc/http_server.h) mais o cliente de notificações.
+// Os valores abaixo são estimativas calculadas, ainda não medidas no aparelho: confirme com
+// tools/http_load.py (--upload para a fila de upload), que mostra o uso máximo e os
+// esgotamentos de cada pool (GET /stats), e registre o resultado na tabela do Readme.
+#define LWIP_HTTP_CLIENTS           4
+// Uploads simultâneos: cada rota de upload aceita um envio por vez (HTTP_MAX_UPLOADS rotas)
+#define LWIP_HTTP_UPLOADS           3
+// Heap do lwIP: cabeçalhos dos segmentos das respostas (enviadas sem cópia, ~100 B cada,
+// até 2 por cliente), requisição de notificação copiada (~500 B), cliente MQTT (~700 B),
+// respostas mDNS (~512 B cada) e beacon/DHCP/ARP. Estimativa ~4 KB; o dobro como margem.
+#define MEM_SIZE                    8192
+// Uma resposta de até 2 KB cabe inteira no buffer de envio
+#define TCP_SND_BUF                 (2 * TCP_MSS)
+// Clientes HTTP + cliente de notificações + margem para conexões em TIME_WAIT
+#define MEMP_NUM_TCP_PCB            (LWIP_HTTP_CLIENTS + 4)
+#define MEMP_NUM_TCP_PCB_LISTEN     2
+// DHCP, DNS, mDNS e beacon
+#define MEMP_NUM_UDP_PCB            6
+#define MEMP_NUM_TCP_SEG            ((LWIP_HTTP_CLIENTS + 1) * TCP_SND_QUEUELEN)
+// pbufs de referência usados pelos envios sem cópia
+#define MEMP_NUM_PBUF               (LWIP_HTTP_CLIENTS * 4)
 #define MEMP_NUM_ARP_QUEUE          10
-#define PBUF_POOL_SIZE              24
+// Recepção: cada quadro recebido ocupa um pbuf do pool (o cyw43 aloca de PBUF_POOL, com
+// PBUF_POOL_BUFSIZE para um segmento de TCP_MSS). Requisições comuns são copiadas e liberadas
+// no callback: 2 quadros por conexão. O corpo de um upload fica na fila até o http_server_poll
+// e a janela só é devolvida depois, então cada upload retém até TCP_WND (4 quadros cheios) mais
+// o pbuf que chegou com os cabeçalhos, cuja janela já foi devolvida. Um cliente que envia
+// segmentos pequenos usa mais pbufs por byte; esgotado o pool o quadro é descartado e o TCP
+// retransmite. + 8 para DHCP/ARP/mDNS/MQTT.
+#define PBUF_POOL_SIZE              (LWIP_HTTP_UPLOADS * (TCP_WND / TCP_MSS + 1) + \
+                                     (LWIP_HTTP_CLIENTS - LWIP_HTTP_UPLOADS) * 2 + 8)
 #define LWIP_ARP                    1
 #define LWIP_ETHERNET               1
 #define LWIP_ICMP                   1
 #define LWIP_RAW                    1
-#define TCP_WND                     (8 * TCP_MSS)
+#define TCP_WND                     (4 * TCP_MSS)
 #define TCP_MSS                     1460
-#define TCP_SND_BUF                 (8 * TCP_MSS)
 #define TCP_SND_QUEUELEN            ((4 * (TCP_SND_BUF) + (TCP_MSS - 1)) / (TCP_MSS))
 #define LWIP_NETIF_STATUS_CALLBACK  1
 #define LWIP_NETIF_LINK_CALLBACK    1
 #define LWIP_NETIF_HOSTNAME         1
 #define LWIP_NETCONN                0
-#define MEM_STATS                   0
+// Contadores de uso/esgotamento dos pools expostos em GET /stats
+#define LWIP_STATS                  1
+#define MEM_STATS                   1
 #define SYS_STATS                   0
-#define MEMP_STATS                  0
+#define MEMP_STATS                  1
 #define LINK_STATS                  0
 // #define ETH_PAD_SIZE                2
 #define LWIP_CHKSUM_ALGORITHM       3
@@ -51,9 +81,22 @@
 #define DHCP_DOES_ARP_CHECK         0
 #define LWIP_DHCP_DOES_ACD_CHECK    0
 
+// mDNS para descoberta como baba-<comodo>.local
+#define LWIP_MDNS_RESPONDER         1
+#define LWIP_IGMP                   1
+#define LWIP_NUM_NETIF_CLIENT_DATA  1
+#define MDNS_RESP_USENETIF_EXTCALLBACK 1
+#define MDNS_MAX_SERVICES           1
+
+// Timeouts extras: keep-alive do cliente MQTT e temporizadores do mDNS
+#define MEMP_NUM_SYS_TIMEOUT        (LWIP_NUM_SYS_TIMEOUT_INTERNAL + 3)
+
+// Cliente MQTT das notificações
+#define MQTT_REQ_MAX_IN_FLIGHT      4
+#define MQTT_OUTPUT_RINGBUF_SIZE    512
+
 #ifndef NDEBUG
 #define LWIP_DEBUG                  1
-#define LWIP_STATS                  1
 #define LWIP_STATS_DISPLAY          1
 #endif
 
@@ -0,0 +1,24 @@
+#ifndef check_inc_h
+#define check_inc_h
+
+#include <stdio.h>
+
+// Verificação mínima: registra a falha e continua; o teste termina com check_result()
+static int check_failures = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: falhou: %s\n", __FILE__, __LINE__, #cond); \
+            check_failures++; \
+        } \
+    } while (0)
+
+static inline int check_result(void) {
+    if (check_failures > 0) {
+        fprintf(stderr, "%d verificacoes falharam\n", check_failures);
+        return 1;
+    }
+    return 0;
+}
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef hardware_i2c_stub_h
+#define hardware_i2c_stub_h
+
+// O teste implementa i2c_write_blocking e recebe os bytes que iriam ao display
+#include "pico/stdlib.h"
+
+typedef struct i2c_inst i2c_inst_t;
+extern i2c_inst_t *i2c1;
+
+extern int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+
+#endif
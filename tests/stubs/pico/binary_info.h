@@ -0,0 +1,4 @@
+#ifndef pico_binary_info_stub_h
+#define pico_binary_info_stub_h
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef pico_stdlib_stub_h
+#define pico_stdlib_stub_h
+
+// Substituto mínimo do pico/stdlib.h para compilar os módulos de tela no computador
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define _u(x) x##u
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+
+#endif
@@ -0,0 +1,71 @@
+#include <string.h>
+#include <time.h>
+#include "check.h"
+#include "auth_hash.h"
+
+static const uint8_t salt[AUTH_SALT_SIZE] = {
+    0x3a, 0x91, 0x07, 0xc4, 0x5e, 0x22, 0xf0, 0x18, 0x6b, 0xd9, 0x41, 0x8e, 0x73, 0x0c, 0xa5, 0xbe
+};
+
+static void test_hash_is_salted(void) {
+    uint8_t salted[SHA256_DIGEST_SIZE];
+    uint8_t plain[SHA256_DIGEST_SIZE];
+    uint8_t same[SHA256_DIGEST_SIZE];
+    const char *token = "novo-token-secreto";
+    auth_hash(salt, token, strlen(token), salted);
+    auth_hash(salt, token, strlen(token), same);
+    CHECK(auth_digest_equal(salted, same));
+
+    // SHA-256(salt || token) é o mesmo que resumir a concatenação de uma vez
+    uint8_t message[AUTH_SALT_SIZE + 32];
+    memcpy(message, salt, AUTH_SALT_SIZE);
+    memcpy(message + AUTH_SALT_SIZE, token, strlen(token));
+    sha256(message, AUTH_SALT_SIZE + strlen(token), plain);
+    CHECK(memcmp(salted, plain, SHA256_DIGEST_SIZE) == 0);
+
+    sha256(token, strlen(token), plain);
+    CHECK(!auth_digest_equal(salted, plain));
+}
+
+static void test_compare_any_byte(void) {
+    uint8_t a[SHA256_DIGEST_SIZE];
+    uint8_t b[SHA256_DIGEST_SIZE];
+    auth_hash(salt, "troque-este-token", 17, a);
+    for (int i = 0; i < SHA256_DIGEST_SIZE; i++) {
+        memcpy(b, a, sizeof(b));
+        b[i] ^= 0x01;
+        CHECK(!auth_digest_equal(a, b));
+    }
+}
+
+// Custo de uma verificação (hash + comparação) com o maior token aceito. No computador é só uma
+// referência: com uma margem de 50x para o RP2040 (Cortex-M0+ a 125 MHz) ela deve caber em
+// AUTH_CHECK_BUDGET_US; o custo real aparece em GET /stats (auth.hash_us_max).
+static void test_cost(void) {
+    char token[64];
+    memset(token, 'x', sizeof(token));
+    uint8_t stored[SHA256_DIGEST_SIZE];
+    auth_hash(salt, "outro-token", 11, stored);
+
+    const int runs = 20000;
+    int matches = 0;
+    clock_t start = clock();
+    for (int i = 0; i < runs; i++) {
+        uint8_t digest[SHA256_DIGEST_SIZE];
+        token[0] = (char)('a' + i % 26);
+        auth_hash(salt, token, sizeof(token), digest);
+        matches += auth_digest_equal(digest, stored);
+    }
+    double us = (double)(clock() - start) * 1e6 / CLOCKS_PER_SEC / runs;
+    printf("%.2f us por verificacao com token de %d bytes (computador), orcamento no aparelho %d us\n",
+           us, (int)sizeof(token), AUTH_CHECK_BUDGET_US);
+    CHECK(matches == 0);
+    CHECK(us * 50 < AUTH_CHECK_BUDGET_US);
+}
+
+int main(void) {
+    test_hash_is_salted();
+    test_compare_any_byte();
+    test_cost();
+    return check_result();
+}
@@ -0,0 +1,84 @@
+#include <string.h>
+#include "check.h"
+#include "beacon.h"
+
+static void test_round_trip(void) {
+    beacon_status_t in = {
+        .flags = BEACON_FLAG_ACTIVE | BEACON_FLAG_CRY,
+        .activity = 73,
+        .seq = 0xBEEF,
+        .uptime_s = 0x12345678,
+        .room = "quarto"
+    };
+    uint8_t buffer[BEACON_MAX_SIZE];
+    size_t len = beacon_encode(&in, buffer, sizeof(buffer));
+    CHECK(len == BEACON_HEADER_SIZE + 6);
+
+    // Layout documentado em beacon.h (little-endian)
+    const uint8_t header[] = { 'B', 'E', BEACON_VERSION, 0x05, 73, 0, 0xEF, 0xBE, 0x78, 0x56, 0x34, 0x12, 6 };
+    CHECK(memcmp(buffer, header, sizeof(header)) == 0);
+    CHECK(memcmp(buffer + BEACON_HEADER_SIZE, "quarto", 6) == 0);
+
+    beacon_status_t out;
+    memset(&out, 0xAA, sizeof(out));
+    CHECK(beacon_decode(buffer, len, &out));
+    CHECK(out.flags == in.flags);
+    CHECK(out.activity == in.activity);
+    CHECK(out.seq == in.seq);
+    CHECK(out.uptime_s == in.uptime_s);
+    CHECK(strcmp(out.room, "quarto") == 0);
+}
+
+static void test_room_limits(void) {
+    beacon_status_t in = { .seq = 1 };
+    uint8_t buffer[BEACON_MAX_SIZE];
+    beacon_status_t out;
+
+    // Cômodo vazio
+    size_t len = beacon_encode(&in, buffer, sizeof(buffer));
+    CHECK(len == BEACON_HEADER_SIZE);
+    CHECK(beacon_decode(buffer, len, &out) && out.room[0] == '\0');
+
+    // Nome com o tamanho máximo
+    memset(in.room, 'x', BEACON_ROOM_MAX);
+    in.room[BEACON_ROOM_MAX] = '\0';
+    len = beacon_encode(&in, buffer, sizeof(buffer));
+    CHECK(len == BEACON_MAX_SIZE);
+    CHECK(beacon_decode(buffer, len, &out) && strlen(out.room) == BEACON_ROOM_MAX);
+
+    // Buffer pequeno demais
+    CHECK(beacon_encode(&in, buffer, BEACON_MAX_SIZE - 1) == 0);
+}
+
+static void test_rejects_invalid(void) {
+    beacon_status_t in = { .activity = 10, .room = "sala" };
+    uint8_t buffer[BEACON_MAX_SIZE];
+    beacon_status_t out;
+    size_t len = beacon_encode(&in, buffer, sizeof(buffer));
+
+    CHECK(!beacon_decode(buffer, BEACON_HEADER_SIZE - 1, &out));  // Cabeçalho truncado
+    CHECK(!beacon_decode(buffer, len - 1, &out));                 // Nome truncado
+
+    buffer[0] = 'X';
+    CHECK(!beacon_decode(buffer, len, &out));                     // Magic
+    buffer[0] = 'B';
+
+    buffer[2] = BEACON_VERSION + 1;
+    CHECK(!beacon_decode(buffer, len, &out));                     // Versão
+    buffer[2] = BEACON_VERSION;
+
+    buffer[12] = BEACON_ROOM_MAX + 1;
+    uint8_t big[BEACON_MAX_SIZE + 1];
+    memcpy(big, buffer, len);
+    CHECK(!beacon_decode(big, sizeof(big), &out));                // Nome acima do limite
+    buffer[12] = 4;
+
+    CHECK(beacon_decode(buffer, len, &out));
+}
+
+int main(void) {
+    test_round_trip();
+    test_room_limits();
+    test_rejects_invalid();
+    return check_result();
+}
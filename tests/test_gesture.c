@@ -0,0 +1,122 @@
+#include "check.h"
+#include "gesture.h"
+
+static gesture_decoder_t decoder;
+static uint32_t now;
+
+// Avança o tempo chamando o tick a cada 20 ms (BUTTON_TICK_MS); retorna o primeiro gesto emitido
+static gesture_t advance(uint32_t ms) {
+    gesture_t first = GESTURE_NONE;
+    for (uint32_t end = now + ms; now < end;) {
+        now += 20;
+        gesture_t g = gesture_tick(&decoder, now);
+        if (g != GESTURE_NONE && first == GESTURE_NONE) {
+            first = g;
+        }
+    }
+    return first;
+}
+
+static gesture_t press(button_id_t button) {
+    return gesture_edge(&decoder, button, true, now);
+}
+
+static gesture_t release(button_id_t button) {
+    return gesture_edge(&decoder, button, false, now);
+}
+
+static void reset(void) {
+    gesture_init(&decoder);
+    now = 1000;
+}
+
+static void test_single_click_waits_for_window(void) {
+    reset();
+    CHECK(press(BUTTON_A) == GESTURE_NONE);
+    advance(80);
+    CHECK(release(BUTTON_A) == GESTURE_NONE);
+    CHECK(advance(GESTURE_DOUBLE_MS - 40) == GESTURE_NONE);  // Janela ainda aberta
+    CHECK(advance(100) == GESTURE_A_CLICK);
+    CHECK(advance(2000) == GESTURE_NONE);                   // Emitido uma única vez
+}
+
+static void test_double_click_has_no_single(void) {
+    reset();
+    press(BUTTON_A);
+    advance(60);
+    CHECK(release(BUTTON_A) == GESTURE_NONE);
+    CHECK(advance(100) == GESTURE_NONE);
+    press(BUTTON_A);
+    CHECK(advance(60) == GESTURE_NONE);
+    CHECK(release(BUTTON_A) == GESTURE_A_DOUBLE);
+    CHECK(advance(2000) == GESTURE_NONE);
+}
+
+static void test_slow_clicks_are_two_singles(void) {
+    reset();
+    press(BUTTON_A);
+    advance(60);
+    release(BUTTON_A);
+    CHECK(advance(GESTURE_DOUBLE_MS + 100) == GESTURE_A_CLICK);
+    press(BUTTON_A);
+    advance(60);
+    CHECK(release(BUTTON_A) == GESTURE_NONE);
+    CHECK(advance(GESTURE_DOUBLE_MS + 100) == GESTURE_A_CLICK);
+}
+
+static void test_b_click_and_long(void) {
+    reset();
+    press(BUTTON_B);
+    advance(200);
+    CHECK(release(BUTTON_B) == GESTURE_B_CLICK);
+
+    press(BUTTON_B);
+    CHECK(advance(GESTURE_LONG_MS - 100) == GESTURE_NONE);
+    CHECK(advance(200) == GESTURE_B_LONG);
+    CHECK(advance(1000) == GESTURE_NONE);
+    CHECK(release(BUTTON_B) == GESTURE_NONE);  // Clique suprimido após o toque longo
+}
+
+static void test_ab_hold_suppresses_clicks(void) {
+    reset();
+    press(BUTTON_A);
+    advance(40);
+    press(BUTTON_B);
+    CHECK(advance(GESTURE_HOLD_BOTH_MS - 100) == GESTURE_NONE);  // Sem B_LONG durante o combo
+    CHECK(advance(200) == GESTURE_AB_HOLD);
+    CHECK(release(BUTTON_A) == GESTURE_NONE);
+    CHECK(release(BUTTON_B) == GESTURE_NONE);
+    CHECK(advance(GESTURE_DOUBLE_MS * 2) == GESTURE_NONE);     // Nem A_CLICK retido
+}
+
+static void test_pending_click_cancelled_by_combo(void) {
+    reset();
+    press(BUTTON_A);
+    advance(40);
+    release(BUTTON_A);
+    advance(40);
+    press(BUTTON_A);
+    press(BUTTON_B);
+    advance(100);
+    release(BUTTON_B);
+    release(BUTTON_A);
+    CHECK(advance(GESTURE_DOUBLE_MS * 2) == GESTURE_NONE);
+}
+
+static void test_release_without_press(void) {
+    reset();
+    CHECK(release(BUTTON_A) == GESTURE_NONE);
+    CHECK(release(BUTTON_B) == GESTURE_NONE);
+    CHECK(advance(1000) == GESTURE_NONE);
+}
+
+int main(void) {
+    test_single_click_waits_for_window();
+    test_double_click_has_no_single();
+    test_slow_clicks_are_two_singles();
+    test_b_click_and_long();
+    test_ab_hold_suppresses_clicks();
+    test_pending_click_cancelled_by_combo();
+    test_release_without_press();
+    return check_result();
+}
@@ -0,0 +1,133 @@
+#include "check.h"
+#include "notify_queue.h"
+
+// Tipos alternados para que eventos seguidos não sejam agrupados
+static notify_event_type_t other(int i) {
+    return i % 2 ? NOTIFY_EVT_ACTIVATED : NOTIFY_EVT_DEACTIVATED;
+}
+
+static void test_coalesce(void) {
+    notify_queue_t queue;
+    notify_queue_init(&queue);
+    notify_queue_push(&queue, NOTIFY_EVT_CRY, 10, 1000);
+    notify_queue_push(&queue, NOTIFY_EVT_CRY, 40, 2000);
+    notify_queue_push(&queue, NOTIFY_EVT_CRY, 20, 1000 + NOTIFY_COALESCE_MS - 1);
+    CHECK(queue.count == 1);
+
+    // A janela conta a partir do primeiro evento, não do último
+    notify_queue_push(&queue, NOTIFY_EVT_CRY, 5, 1000 + NOTIFY_COALESCE_MS);
+    CHECK(queue.count == 2);
+
+    // Outro tipo não entra no grupo, mesmo dentro da janela
+    notify_queue_push(&queue, NOTIFY_EVT_DEACTIVATED, 0, 1000 + NOTIFY_COALESCE_MS + 1);
+    CHECK(queue.count == 3);
+
+    // O envio espera a janela do mais antigo fechar
+    CHECK(notify_queue_next(&queue, 1000 + NOTIFY_COALESCE_MS - 1) == NULL);
+    const notify_entry_t *entry = notify_queue_next(&queue, 1000 + NOTIFY_COALESCE_MS);
+    CHECK(entry != NULL);
+    CHECK(entry->type == NOTIFY_EVT_CRY && entry->count == 3 && entry->peak_activity == 40);
+    CHECK(entry->first_ms == 1000 && entry->last_ms == 1000 + NOTIFY_COALESCE_MS - 1);
+
+    // Um só envio por vez
+    CHECK(notify_queue_next(&queue, 1000 + 3 * NOTIFY_COALESCE_MS) == NULL);
+    CHECK(notify_queue_done(&queue, true, 1000 + 3 * NOTIFY_COALESCE_MS) == 0);
+    entry = notify_queue_next(&queue, 1000 + 3 * NOTIFY_COALESCE_MS);
+    CHECK(entry != NULL && entry->count == 1 && entry->peak_activity == 5);
+}
+
+// Fila cheia: o mais antigo é descartado, exceto o que está em envio
+static void test_overflow(void) {
+    notify_queue_t queue;
+    notify_queue_init(&queue);
+    for (int i = 0; i < NOTIFY_OUTBOX_SIZE + 2; i++) {
+        notify_queue_push(&queue, other(i), (uint8_t)i, 100 * i);
+    }
+    CHECK(queue.count == NOTIFY_OUTBOX_SIZE);
+    CHECK(queue.dropped == 2);
+    CHECK(queue.entries[queue.head].peak_activity == 2);
+
+    uint32_t now = 100 * NOTIFY_OUTBOX_SIZE + NOTIFY_COALESCE_MS;
+    const notify_entry_t *sending = notify_queue_next(&queue, now);
+    CHECK(sending != NULL && sending->peak_activity == 2);
+    notify_queue_push(&queue, other(NOTIFY_OUTBOX_SIZE + 2), 99, now);
+    CHECK(queue.count == NOTIFY_OUTBOX_SIZE);
+    CHECK(queue.dropped == 3);
+    CHECK(sending->peak_activity == 2);  // O evento em envio continua no lugar
+
+    // Confirmado o envio, a ordem segue do 4º evento até o recém-chegado
+    now += NOTIFY_COALESCE_MS;
+    notify_queue_done(&queue, true, now);
+    for (int expected = 4; expected < NOTIFY_OUTBOX_SIZE + 2; expected++) {
+        const notify_entry_t *entry = notify_queue_next(&queue, now);
+        CHECK(entry != NULL && entry->peak_activity == expected);
+        notify_queue_done(&queue, true, now);
+    }
+    const notify_entry_t *last = notify_queue_next(&queue, now);
+    CHECK(last != NULL && last->peak_activity == 99);
+    notify_queue_done(&queue, true, now);
+    CHECK(queue.count == 0);
+    CHECK(notify_queue_next(&queue, now) == NULL);
+}
+
+// Falhas dobram a espera a partir de NOTIFY_BACKOFF_MIN_MS até NOTIFY_BACKOFF_MAX_MS; um sucesso zera
+static void test_backoff(void) {
+    notify_queue_t queue;
+    notify_queue_init(&queue);
+    notify_queue_push(&queue, NOTIFY_EVT_CRY, 50, 0);
+    notify_queue_push(&queue, NOTIFY_EVT_ACTIVATED, 0, 0);
+
+    uint32_t now = NOTIFY_COALESCE_MS;
+    uint32_t expected = NOTIFY_BACKOFF_MIN_MS;
+    int at_max = 0;
+    for (int attempt = 0; attempt < 10; attempt++) {
+        CHECK(notify_queue_next(&queue, now) != NULL);
+        CHECK(notify_queue_done(&queue, false, now) == expected);
+        CHECK(queue.count == 2);  // O evento continua na fila
+        CHECK(notify_queue_next(&queue, now + expected - 1) == NULL);
+        now += expected;
+        if (expected == NOTIFY_BACKOFF_MAX_MS) {
+            at_max++;
+        }
+        expected = expected * 2 > NOTIFY_BACKOFF_MAX_MS ? NOTIFY_BACKOFF_MAX_MS : expected * 2;
+    }
+    CHECK(at_max >= 3);  // 1, 2, 4, 8, 16, 32 s e depois o teto
+
+    const notify_entry_t *entry = notify_queue_next(&queue, now);
+    CHECK(entry != NULL && entry->type == NOTIFY_EVT_CRY);
+    CHECK(notify_queue_done(&queue, true, now) == 0);
+    CHECK(queue.backoff_ms == 0);
+
+    // Após o sucesso o próximo evento sai na hora e uma nova falha volta ao mínimo
+    entry = notify_queue_next(&queue, now);
+    CHECK(entry != NULL && entry->type == NOTIFY_EVT_ACTIVATED);
+    CHECK(notify_queue_done(&queue, false, now) == NOTIFY_BACKOFF_MIN_MS);
+}
+
+// Instantes perto do estouro do contador de ms
+static void test_wraparound(void) {
+    notify_queue_t queue;
+    notify_queue_init(&queue);
+    uint32_t start = UINT32_MAX - 1000;
+    notify_queue_push(&queue, NOTIFY_EVT_CRY, 1, start);
+    notify_queue_push(&queue, NOTIFY_EVT_CRY, 2, start + 2000);
+    CHECK(queue.count == 1);
+    CHECK(notify_queue_next(&queue, start + NOTIFY_COALESCE_MS - 1) == NULL);
+    CHECK(notify_queue_next(&queue, start + NOTIFY_COALESCE_MS) != NULL);
+    notify_queue_done(&queue, false, start + NOTIFY_COALESCE_MS);
+    CHECK(notify_queue_next(&queue, start + NOTIFY_COALESCE_MS + NOTIFY_BACKOFF_MIN_MS - 1) == NULL);
+    CHECK(notify_queue_next(&queue, start + NOTIFY_COALESCE_MS + NOTIFY_BACKOFF_MIN_MS) != NULL);
+
+    // Primeiro evento depois de 2^31 ms ligado, sem nenhum envio antes
+    notify_queue_init(&queue);
+    notify_queue_push(&queue, NOTIFY_EVT_CRY, 1, 0x90000000u);
+    CHECK(notify_queue_next(&queue, 0x90000000u + NOTIFY_COALESCE_MS) != NULL);
+}
+
+int main(void) {
+    test_coalesce();
+    test_overflow();
+    test_backoff();
+    test_wraparound();
+    return check_result();
+}
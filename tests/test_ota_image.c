@@ -0,0 +1,321 @@
+#include <stdlib.h>
+#include <string.h>
+#include "check.h"
+#include "ota_image.h"
+
+// Flash de 2 MB em RAM. As gravações são numeradas desde restart(); na operação fail_at a
+// gravação fica pela metade (setor apagado e meio gravado, ou meia página) e falha, com a flash
+// seguindo funcional; na operação cut_at o mesmo acontece e a energia cai: nada mais é gravado
+// até o próximo "boot" (nova chamada de ota_boot). O registro de controle é a exceção: numa
+// falha ele não é alterado (o teste cobre os passos da troca e do diário, não um registro rasgado).
+// Na operação corrupt_at a gravação sai pela metade mas é dada como bem-sucedida.
+#define FLASH_SIZE (2 * 1024 * 1024)
+#define DATA_REGION (FLASH_SIZE - 64 * 1024)
+#define CONTROL (DATA_REGION + 20 * 1024)
+
+static uint8_t flash[FLASH_SIZE];
+static uint8_t initial[FLASH_SIZE];
+static long ops;
+static long fail_at;
+static long cut_at;
+static long corrupt_at = -1;
+static bool powered;
+
+typedef enum { WRITE_OK, WRITE_TORN, WRITE_OFF, WRITE_SILENT } write_t;
+
+static write_t consume(void) {
+    if (!powered) {
+        return WRITE_OFF;
+    }
+    long op = ops++;
+    if (op == cut_at) {
+        powered = false;
+        return WRITE_TORN;
+    }
+    if (op == corrupt_at) {
+        return WRITE_SILENT;
+    }
+    return op == fail_at ? WRITE_TORN : WRITE_OK;
+}
+
+static const uint8_t *flash_read(uint32_t offset) {
+    return flash + offset;
+}
+
+static bool flash_erase_program(uint32_t offset, const uint8_t *data, uint32_t len) {
+    CHECK(offset % OTA_SECTOR_SIZE == 0);
+    write_t result = consume();
+    if (result == WRITE_OFF || (result == WRITE_TORN && offset == CONTROL)) {
+        return false;
+    }
+    uint32_t erase = (len + OTA_SECTOR_SIZE - 1) & ~(OTA_SECTOR_SIZE - 1);
+    memset(flash + offset, 0xFF, erase);
+    memcpy(flash + offset, data, result == WRITE_OK ? len : len / 2);
+    return result == WRITE_OK || result == WRITE_SILENT;
+}
+
+static bool flash_program(uint32_t offset, const uint8_t *data, uint32_t len) {
+    CHECK(offset % OTA_PAGE_SIZE == 0);
+    write_t result = consume();
+    if (result == WRITE_OFF) {
+        return false;
+    }
+    for (uint32_t i = 0; i < (result == WRITE_OK ? len : len / 2); i++) {
+        flash[offset + i] &= data[i];  // Programar só zera bits
+    }
+    return result == WRITE_OK || result == WRITE_SILENT;
+}
+
+static const ota_flash_t test_flash = {
+    .read = flash_read,
+    .erase_program = flash_erase_program,
+    .program = flash_program,
+    .control = CONTROL,
+    .journal = DATA_REGION + 24 * 1024,
+    .scratch = DATA_REGION + 28 * 1024
+};
+
+static uint32_t fake_us = 0;
+
+static uint32_t now_us(void) {
+    return fake_us += 1000;
+}
+
+// Imagem anterior (5 setores e meio) no slot A e imagem nova (3 setores e meio) no slot B
+#define OLD_SIZE (5 * OTA_SECTOR_SIZE + 2000)
+#define NEW_SIZE (3 * OTA_SECTOR_SIZE + 1500)
+#define SWAP_SIZE (6 * OTA_SECTOR_SIZE)
+
+static uint8_t old_image[SWAP_SIZE];
+static uint8_t new_image[SWAP_SIZE];
+
+static void fill_image(uint8_t *image, uint32_t size) {
+    memset(image, 0xFF, SWAP_SIZE);
+    for (uint32_t i = 0; i < size; i++) {
+        image[i] = (uint8_t)rand();
+    }
+}
+
+static void setup_pending(void) {
+    memset(flash, 0xFF, sizeof(flash));
+    fill_image(old_image, OLD_SIZE);
+    fill_image(new_image, NEW_SIZE);
+    memcpy(flash + OTA_SLOT_A, old_image, SWAP_SIZE);
+    memcpy(flash + OTA_SLOT_B, new_image, SWAP_SIZE);
+
+    ota_control_t control;
+    ota_control_load(&test_flash, &control);
+    control.state = OTA_STATE_PENDING;
+    control.image_size = NEW_SIZE;
+    control.swap_size = SWAP_SIZE;
+    sha256(new_image, NEW_SIZE, control.sha256);
+    fail_at = cut_at = -1;
+    powered = true;
+    CHECK(ota_control_store(&test_flash, &control));
+    memcpy(initial, flash, sizeof(flash));
+}
+
+// Restaura a flash de partida e agenda a falha e a queda de energia (-1 = nenhuma)
+static void restart(long fail, long cut) {
+    memcpy(flash, initial, sizeof(flash));
+    ops = 0;
+    fail_at = fail;
+    cut_at = cut;
+    powered = true;
+}
+
+// Liga o aparelho de novo até o bootloader terminar sem queda de energia
+static bool boot_until_done(ota_control_t *control) {
+    for (;;) {
+        bool trial = ota_boot(&test_flash, control, now_us);
+        if (powered) {
+            return trial;
+        }
+        powered = true;
+    }
+}
+
+static bool slots_are(const uint8_t *a, const uint8_t *b) {
+    return memcmp(flash + OTA_SLOT_A, a, SWAP_SIZE) == 0 && memcmp(flash + OTA_SLOT_B, b, SWAP_SIZE) == 0;
+}
+
+static bool erased(uint32_t offset, uint32_t len) {
+    for (uint32_t i = 0; i < len; i++) {
+        if (flash[offset + i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Gravações de um boot sem falhas a partir do estado inicial
+static long count_ops(void) {
+    ota_control_t control;
+    restart(-1, -1);
+    ota_boot(&test_flash, &control, now_us);
+    return ops;
+}
+
+// Queda de energia em cada gravação da troca: o boot seguinte retoma e a imagem nova entra em teste
+static void test_swap_power_cut(void) {
+    setup_pending();
+    long total = count_ops();
+    CHECK(total > 3 * (SWAP_SIZE / OTA_SECTOR_SIZE));
+
+    for (long cut = 0; cut < total; cut++) {
+        restart(-1, cut);
+        ota_control_t control;
+        CHECK(boot_until_done(&control));
+        CHECK(control.state == OTA_STATE_TRIAL);
+        CHECK(slots_are(new_image, old_image));
+    }
+}
+
+// Imagem em teste que não confirmou: queda de energia em cada passo do rollback
+static void test_rollback_power_cut(void) {
+    setup_pending();
+    restart(-1, -1);
+    ota_control_t control;
+    CHECK(ota_boot(&test_flash, &control, now_us));
+    memcpy(initial, flash, sizeof(flash));  // Parte do estado TRIAL
+
+    long total = count_ops();
+    for (long cut = 0; cut < total; cut++) {
+        restart(-1, cut);
+        CHECK(boot_until_done(&control) == false);
+        CHECK(control.state == OTA_STATE_IDLE);
+        CHECK(control.result == OTA_RESULT_ROLLED_BACK);
+        CHECK(slots_are(old_image, new_image));
+    }
+}
+
+// Falha de gravação em cada passo da troca: só os passos concluídos são desfeitos, e o rollback
+// resiste a uma queda de energia em qualquer gravação depois da falha
+static void test_partial_swap_undo(void) {
+    setup_pending();
+    long total = count_ops();
+    int undone = 0;
+
+    for (long fail = 0; fail < total; fail++) {
+        restart(fail, -1);
+        ota_control_t control;
+        ota_boot(&test_flash, &control, now_us);
+        long after = ops;
+        if (control.state != OTA_STATE_IDLE) {
+            continue;  // Falha antes da troca (PENDING, tentado de novo) ou no registro do TRIAL
+        }
+        CHECK(control.result == OTA_RESULT_INVALID);
+        CHECK(slots_are(old_image, new_image));
+        undone++;
+
+        for (long cut = fail + 1; cut < after; cut++) {
+            restart(fail, cut);
+            if (boot_until_done(&control)) {
+                // Queda antes de registrar o SWAP_BACK: o boot seguinte retoma e conclui a troca
+                CHECK(cut == fail + 1);
+                CHECK(control.state == OTA_STATE_TRIAL);
+                CHECK(slots_are(new_image, old_image));
+                continue;
+            }
+            CHECK(control.state == OTA_STATE_IDLE);
+            CHECK(control.result == OTA_RESULT_INVALID);
+            CHECK(slots_are(old_image, new_image));
+        }
+    }
+    CHECK(undone >= 3 * (SWAP_SIZE / OTA_SECTOR_SIZE));
+}
+
+// Slot B corrompido depois do envio: o PENDING confere de novo e desiste sem tocar no slot A
+// nem no diário, mesmo com queda de energia ao registrar o resultado
+static void test_pending_reverify(void) {
+    setup_pending();
+    initial[OTA_SLOT_B + NEW_SIZE / 2] ^= 0x01;
+    uint8_t corrupted[SWAP_SIZE];
+    memcpy(corrupted, initial + OTA_SLOT_B, SWAP_SIZE);
+
+    for (long cut = -1; cut <= 0; cut++) {
+        restart(-1, cut);
+        ota_control_t control;
+        CHECK(boot_until_done(&control) == false);
+        CHECK(control.state == OTA_STATE_IDLE);
+        CHECK(control.result == OTA_RESULT_INVALID);
+        CHECK(slots_are(old_image, corrupted));
+        CHECK(erased(test_flash.journal, OTA_SECTOR_SIZE));
+        CHECK(ota_control_load(&test_flash, &control) && control.state == OTA_STATE_IDLE);
+        CHECK(ops == (cut < 0 ? 1 : 2));  // Só o registro de controle (de novo após a queda)
+    }
+}
+
+static void put_u32(uint32_t offset, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        flash[offset + i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+// Tabela de vetores de uma imagem em base, ligada para executar do slot A
+static bool plausible(uint32_t stack, uint32_t reset, uint32_t size) {
+    put_u32(OTA_SLOT_B + OTA_VECTOR_OFFSET, stack);
+    put_u32(OTA_SLOT_B + OTA_VECTOR_OFFSET + 4, reset);
+    return ota_image_plausible(&test_flash, OTA_SLOT_B, size);
+}
+
+static void test_image_plausible(void) {
+    const uint32_t entry = OTA_XIP_BASE + OTA_SLOT_A + OTA_VECTOR_OFFSET + 0x100;
+    CHECK(plausible(OTA_RAM_END, entry | 1, NEW_SIZE));
+    CHECK(plausible(OTA_RAM_BASE + 4, entry | 1, NEW_SIZE));
+
+    // Pilha fora da RAM (inclusive flash apagada)
+    CHECK(!plausible(OTA_RAM_BASE, entry | 1, NEW_SIZE));
+    CHECK(!plausible(OTA_RAM_END + 4, entry | 1, NEW_SIZE));
+    CHECK(!plausible(0xFFFFFFFF, 0xFFFFFFFF, NEW_SIZE));
+
+    // Reset sem o bit thumb, no boot2 ou além do fim da imagem
+    CHECK(!plausible(OTA_RAM_END, entry, NEW_SIZE));
+    CHECK(!plausible(OTA_RAM_END, OTA_XIP_BASE + OTA_SLOT_A + OTA_VECTOR_OFFSET, NEW_SIZE));
+    CHECK(!plausible(OTA_RAM_END, (OTA_XIP_BASE + OTA_SLOT_A + NEW_SIZE) | 1, NEW_SIZE));
+    CHECK(plausible(OTA_RAM_END, (OTA_XIP_BASE + OTA_SLOT_A + NEW_SIZE - 2) | 1, NEW_SIZE));
+
+    // Imagem ligada para o início da flash (sem o bootloader) ou para o slot B
+    CHECK(!plausible(OTA_RAM_END, (OTA_XIP_BASE + OTA_VECTOR_OFFSET + 0x100) | 1, NEW_SIZE));
+    CHECK(!plausible(OTA_RAM_END, (OTA_XIP_BASE + OTA_SLOT_B + OTA_VECTOR_OFFSET + 0x100) | 1, NEW_SIZE));
+
+    // Tamanho sem a tabela de vetores ou maior que o slot
+    CHECK(!plausible(OTA_RAM_END, entry | 1, OTA_VECTOR_OFFSET + 7));
+    CHECK(plausible(OTA_RAM_END, (OTA_XIP_BASE + OTA_SLOT_A + OTA_VECTOR_OFFSET + 8) | 1, OTA_VECTOR_OFFSET + 10));
+    CHECK(!plausible(OTA_RAM_END, entry | 1, OTA_SLOT_SIZE + 1));
+}
+
+// Um setor que não grava direito é recusado pelo ota_writer (releitura logo após a gravação)
+static void test_writer_reads_back(void) {
+    setup_pending();
+    ota_writer_t writer;
+    uint8_t digest[SHA256_DIGEST_SIZE];
+
+    restart(-1, -1);
+    ota_writer_begin(&writer, &test_flash, OTA_SLOT_B, NEW_SIZE);
+    CHECK(ota_writer_write(&writer, new_image, 1000));
+    CHECK(ota_writer_write(&writer, new_image + 1000, NEW_SIZE - 1000));
+    CHECK(ota_writer_finish(&writer, digest));
+    CHECK(memcmp(digest, ((const ota_control_t *)(flash + CONTROL))->sha256, SHA256_DIGEST_SIZE) == 0);
+    CHECK(memcmp(flash + OTA_SLOT_B, new_image, NEW_SIZE) == 0);
+
+    restart(-1, -1);
+    corrupt_at = 1;
+    ota_writer_begin(&writer, &test_flash, OTA_SLOT_B, NEW_SIZE);
+    CHECK(ota_writer_write(&writer, new_image, NEW_SIZE) == false);
+    CHECK(writer.failed);
+    CHECK(writer.received == 2 * OTA_SECTOR_SIZE);  // Parou no setor que não conferiu
+    CHECK(ota_writer_finish(&writer, digest) == false);
+    corrupt_at = -1;
+}
+
+int main(void) {
+    srand(7);
+    test_swap_power_cut();
+    test_rollback_power_cut();
+    test_partial_swap_undo();
+    test_writer_reads_back();
+    test_pending_reverify();
+    test_image_plausible();
+    return check_result();
+}
@@ -0,0 +1,168 @@
+#include <string.h>
+#include "check.h"
+#include "policy.h"
+
+// Mesmas janelas de baba_eletronica.c: blocos de 50 ms, janela curta de 2 s e longa de 10 s
+#define BLOCK_MS 50
+#define LONG_BLOCKS (10000 / BLOCK_MS)
+#define SHORT_BLOCKS (2000 / BLOCK_MS)
+
+static policy_t policy;
+static policy_window_t window;
+static uint32_t now_ms;
+static uint8_t last_short, last_long;
+
+// Registro das ações da reprodução
+static policy_action_t actions[32];
+static uint32_t action_ms[32];
+static int action_count;
+
+static void reset(void) {
+    policy_init(&policy);
+    policy_window_init(&window, LONG_BLOCKS, SHORT_BLOCKS);
+    now_ms = 0;
+    action_count = 0;
+}
+
+// Reproduz duration_ms de blocos; a cada period blocos, active deles ficam acima do limiar
+static void replay(uint32_t duration_ms, int active, int period) {
+    for (uint32_t t = 0; t < duration_ms; t += BLOCK_MS) {
+        now_ms += BLOCK_MS;
+        int phase = (now_ms / BLOCK_MS) % period;
+        policy_window_push(&window, phase < active, &last_short, &last_long);
+        policy_action_t action = policy_update(&policy, last_short, last_long, now_ms);
+        if (action.type != POLICY_ACTION_NONE && action_count < 32) {
+            action_ms[action_count] = now_ms;
+            actions[action_count++] = action;
+        }
+    }
+}
+
+static void silence(uint32_t duration_ms) {
+    replay(duration_ms, 0, 1);
+}
+
+static void test_window_percentages(void) {
+    reset();
+    replay(SHORT_BLOCKS * BLOCK_MS, 1, 1);  // 2 s contínuos
+    CHECK(last_short == 100);
+    CHECK(last_long == 20);
+    silence(SHORT_BLOCKS * BLOCK_MS);
+    CHECK(last_short == 0);
+    CHECK(last_long == 20);
+    silence(8000);                           // Os blocos ativos saem da janela longa
+    CHECK(last_long == 0);
+    CHECK(policy_window_long_pct(&window) == 0);
+
+    reset();
+    replay(20000, 1, 4);                     // Um bloco em cada quatro
+    CHECK(last_short == 25);
+    CHECK(last_long == 25);
+}
+
+static void test_escalation(void) {
+    reset();
+    replay(30000, 1, 1);  // Choro contínuo
+    CHECK(action_count == 3);
+    CHECK(actions[0].type == POLICY_ACTION_PLAY && actions[0].level == 1);
+    CHECK(strcmp(actions[0].tier->name, "agitado") == 0);
+    CHECK(actions[1].level == 2 && actions[1].tier->notify);
+    CHECK(actions[2].level == 3 && actions[2].tier->volume == 100);
+    // Curta >= 25% após 10 blocos; longa >= 15% após 30; longa >= 40% após 80
+    CHECK(action_ms[0] == 10 * BLOCK_MS);
+    CHECK(action_ms[1] == 30 * BLOCK_MS);
+    CHECK(action_ms[2] == 80 * BLOCK_MS);
+}
+
+static void test_level_does_not_drop_while_active(void) {
+    reset();
+    replay(10000, 1, 1);
+    CHECK(policy.level == 3);
+    replay(60000, 1, 3);  // Atividade menor, mas ainda presente: mantém o nível
+    CHECK(policy.level == 3);
+    CHECK(action_count == 3);
+}
+
+static void test_fade_after_quiet(void) {
+    reset();
+    replay(5000, 1, 1);
+    int played = action_count;
+    silence(POLICY_QUIET_MS);                 // A janela curta leva 2 s para esvaziar
+    CHECK(action_count == played);
+    silence(3000);
+    CHECK(action_count == played + 1);
+    CHECK(actions[played].type == POLICY_ACTION_FADE);
+    CHECK(policy.level == 0);
+    // Silêncio começou quando a janela curta caiu a quiet_pct
+    uint32_t fade_at = action_ms[played];
+    CHECK(fade_at > 5000 + POLICY_QUIET_MS && fade_at <= 5000 + POLICY_QUIET_MS + 2000);
+    silence(60000);
+    CHECK(action_count == played + 1);
+}
+
+static void test_residual_blocks_count_as_quiet(void) {
+    // Um bloco isolado acima do limiar a cada 2 s (ruído ou resto do tom) não impede o fade
+    reset();
+    replay(5000, 1, 1);
+    int played = action_count;
+    replay(POLICY_QUIET_MS + 5000, 1, SHORT_BLOCKS);
+    CHECK(last_short <= POLICY_QUIET_PCT);
+    CHECK(action_count == played + 1);
+    CHECK(actions[played].type == POLICY_ACTION_FADE);
+
+    // Com quiet_pct = 0 (exigir silêncio absoluto) a resposta nunca encerra
+    reset();
+    policy.quiet_pct = 0;
+    replay(5000, 1, 1);
+    played = action_count;
+    replay(60000, 1, SHORT_BLOCKS);
+    CHECK(action_count == played);
+}
+
+static void test_activity_interrupts_quiet(void) {
+    reset();
+    replay(5000, 1, 1);
+    int played = action_count;
+    silence(15000);
+    replay(1000, 1, 1);                       // Novo choro antes do prazo reinicia a contagem
+    silence(15000);
+    CHECK(action_count == played);
+    CHECK(policy.level > 0);
+    silence(10000);
+    CHECK(action_count == played + 1 && actions[played].type == POLICY_ACTION_FADE);
+}
+
+static void test_runtime_tier_change(void) {
+    reset();
+    policy.tiers[0].min_short_pct = 60;       // Como GET /policy?tier=1&short=60
+    policy.quiet_ms = 5000;
+    replay(1000, 1, 2);                        // 50% na janela curta: abaixo do novo mínimo
+    CHECK(action_count == 0);
+    replay(2000, 1, 1);
+    CHECK(action_count >= 1 && actions[0].level == 1);
+    silence(8000);
+    CHECK(actions[action_count - 1].type == POLICY_ACTION_FADE);
+}
+
+static void test_reset(void) {
+    reset();
+    replay(10000, 1, 1);
+    policy_reset(&policy);
+    policy_window_init(&window, LONG_BLOCKS, SHORT_BLOCKS);
+    CHECK(policy.level == 0);
+    int played = action_count;
+    silence(60000);
+    CHECK(action_count == played);  // Nada a encerrar após o reset
+}
+
+int main(void) {
+    test_window_percentages();
+    test_escalation();
+    test_level_does_not_drop_while_active();
+    test_fade_after_quiet();
+    test_residual_blocks_count_as_quiet();
+    test_activity_interrupts_quiet();
+    test_runtime_tier_change();
+    test_reset();
+    return check_result();
+}
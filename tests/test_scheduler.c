@@ -0,0 +1,142 @@
+#include <string.h>
+#include "check.h"
+#include "scheduler.h"
+
+// Relógio virtual: o teste avança o tempo e as tarefas podem "gastar" tempo ao executar
+static uint64_t clock_us;
+static uint32_t cost_us;
+
+static uint64_t virtual_clock(void) {
+    return clock_us;
+}
+
+static char trace[64];
+static int trace_len;
+
+static void record(void *ctx) {
+    if (trace_len < (int)sizeof(trace) - 1) {
+        trace[trace_len++] = *(const char *)ctx;
+        trace[trace_len] = '\0';
+    }
+    clock_us += cost_us;
+}
+
+static void reset(scheduler_t *sched) {
+    clock_us = 0;
+    cost_us = 0;
+    trace_len = 0;
+    trace[0] = '\0';
+    sched_init(sched, virtual_clock);
+}
+
+// Executa tudo o que estiver pronto a cada ms até o instante final
+static void run_until(scheduler_t *sched, uint64_t end_us) {
+    while (clock_us < end_us) {
+        while (sched_run_next(sched)) {
+        }
+        clock_us += 1000;
+    }
+}
+
+static void test_periodic_and_priority(void) {
+    scheduler_t sched;
+    reset(&sched);
+    int low = sched_add_periodic(&sched, "baixa", 10, 1, record, "l");
+    int high = sched_add_periodic(&sched, "alta", 10, 5, record, "h");
+    CHECK(sched_next_deadline(&sched) == 10000);
+    CHECK(!sched_run_next(&sched));
+    run_until(&sched, 35000);
+    CHECK(strcmp(trace, "hlhlhl") == 0);  // Mesmo prazo: a de maior prioridade primeiro
+    CHECK(sched_get_task(&sched, low)->runs == 3);
+    CHECK(sched_get_task(&sched, high)->runs == 3);
+    CHECK(sched_get_task(&sched, high)->overruns == 0);
+}
+
+static void test_oneshot_runs_once(void) {
+    scheduler_t sched;
+    reset(&sched);
+    int id = sched_add_oneshot(&sched, "unica", 5, 1, record, "o");
+    run_until(&sched, 50000);
+    CHECK(strcmp(trace, "o") == 0);
+    CHECK(!sched_get_task(&sched, id)->active);
+    CHECK(sched_next_deadline(&sched) == SCHED_NO_DEADLINE);
+}
+
+static void test_late_start_and_overrun(void) {
+    scheduler_t sched;
+    reset(&sched);
+    int id = sched_add_periodic(&sched, "lenta", 10, 1, record, "s");
+    clock_us = 13000;                     // Começa 3 ms atrasada
+    cost_us = 25000;                      // E leva mais que dois períodos
+    CHECK(sched_run_next(&sched));
+    const sched_task_t *task = sched_get_task(&sched, id);
+    CHECK(task->max_late_us == 3000);
+    CHECK(task->max_us == 25000);
+    CHECK(task->overruns == 1);           // Execução mais longa que o período
+    CHECK(task->next_run_us == 20000);
+    cost_us = 0;
+    CHECK(sched_run_next(&sched));        // Prazo de 20 ms já passou (relógio em 38 ms)
+    CHECK(task->overruns == 2);           // Ativações perdidas descartadas, sem rajada
+    CHECK(task->next_run_us == 48000);
+    CHECK(!sched_run_next(&sched));
+}
+
+static void test_cancel(void) {
+    scheduler_t sched;
+    reset(&sched);
+    int id = sched_add_periodic(&sched, "cancelada", 10, 1, record, "c");
+    run_until(&sched, 15000);
+    sched_cancel(&sched, id);
+    run_until(&sched, 100000);
+    CHECK(strcmp(trace, "c") == 0);
+}
+
+static void test_same_name_keeps_accounting(void) {
+    scheduler_t sched;
+    reset(&sched);
+    int first = sched_add_oneshot(&sched, "nota", 1, 1, record, "n");
+    run_until(&sched, 5000);
+    int second = sched_add_oneshot(&sched, "nota", 1, 1, record, "n");
+    CHECK(second == first);
+    run_until(&sched, 10000);
+    CHECK(sched_get_task(&sched, second)->runs == 2);
+}
+
+static void test_reuses_any_free_slot(void) {
+    scheduler_t sched;
+    reset(&sched);
+    static const char *const names[SCHED_MAX_TASKS] = { "t0", "t1", "t2", "t3", "t4", "t5",
+                                                        "t6", "t7", "t8", "t9", "t10", "t11" };
+    for (int i = 0; i < SCHED_MAX_TASKS; i++) {
+        CHECK(sched_add_oneshot(&sched, names[i], 1 + i, 1, record, "x") == i);
+    }
+    CHECK(sched_add_oneshot(&sched, "cheia", 1, 1, record, "x") == -1);
+
+    run_until(&sched, 5000);              // t0..t3 concluídas (prazos de 1 a 4 ms)
+    int id = sched_add_periodic(&sched, "nova", 10, 1, record, "y");
+    CHECK(id >= 0 && id < 4);             // Posição livre com outro nome é reaproveitada
+    CHECK(strcmp(sched_get_task(&sched, id)->name, "nova") == 0);
+    CHECK(sched_get_task(&sched, id)->runs == 0);  // Contabilidade zerada para a tarefa nova
+    CHECK(sched_get_task(&sched, id)->active);
+}
+
+static void test_prefers_unused_slot(void) {
+    scheduler_t sched;
+    reset(&sched);
+    int done = sched_add_oneshot(&sched, "antiga", 1, 1, record, "a");
+    run_until(&sched, 5000);
+    int id = sched_add_oneshot(&sched, "outra", 1, 1, record, "b");
+    CHECK(id != done);                    // Mantém a contabilidade da concluída enquanto houver espaço
+    CHECK(sched_get_task(&sched, done)->runs == 1);
+}
+
+int main(void) {
+    test_periodic_and_priority();
+    test_oneshot_runs_once();
+    test_late_start_and_overrun();
+    test_cancel();
+    test_same_name_keeps_accounting();
+    test_reuses_any_free_slot();
+    test_prefers_unused_slot();
+    return check_result();
+}
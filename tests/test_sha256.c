@@ -0,0 +1,86 @@
+#include <string.h>
+#include "check.h"
+#include "sha256.h"
+
+// Vetores do FIPS 180-2 (apêndice B) e tamanhos nas bordas do preenchimento
+typedef struct {
+    const char *message;
+    size_t repeat;          // Mensagem repetida (para o milhão de 'a')
+    const char *digest;
+} vector_t;
+
+static const vector_t vectors[] = {
+    { "abc", 1, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" },
+    { "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 1,
+      "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" },
+    { "a", 1000000, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" },
+    { "", 1, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+    { "a", 55, "9f4390f8d30c2dd92ec9f095b65e2b9ae9b0a925a5258e241c9f1e910f734318" },
+    { "a", 56, "b35439a4ac6f0948b6d6f9e3c6af0f5f590ce20f1bde7090ef7970686ec6738a" },
+    { "a", 63, "7d3e74a05d7db15bce4ad9ec0658ea98e3f06eeecf16b4c6fff2da457ddc2f34" },
+    { "a", 64, "ffe054fe7ae0cb6dc65c3af9b61d5209f439851db43d0ba5997337df154668eb" },
+    { "a", 65, "635361c48bb9eab14198e76ea8ab7f1a41685d6ad62aa9146d301d4f17eb0ae0" },
+};
+
+static void to_hex(const uint8_t *digest, char *hex) {
+    for (int i = 0; i < SHA256_DIGEST_SIZE; i++) {
+        sprintf(hex + 2 * i, "%02x", digest[i]);
+    }
+}
+
+static void test_vectors(void) {
+    for (size_t v = 0; v < sizeof(vectors) / sizeof(vectors[0]); v++) {
+        const vector_t *vector = &vectors[v];
+        size_t len = strlen(vector->message);
+        sha256_t ctx;
+        uint8_t digest[SHA256_DIGEST_SIZE];
+        char hex[2 * SHA256_DIGEST_SIZE + 1];
+
+        sha256_init(&ctx);
+        for (size_t i = 0; i < vector->repeat; i++) {
+            sha256_update(&ctx, vector->message, len);
+        }
+        sha256_final(&ctx, digest);
+        to_hex(digest, hex);
+        CHECK(strcmp(hex, vector->digest) == 0);
+
+        if (vector->repeat == 1) {
+            sha256(vector->message, len, digest);
+            to_hex(digest, hex);
+            CHECK(strcmp(hex, vector->digest) == 0);
+        }
+    }
+}
+
+// O resultado não depende de como a mensagem é dividida entre as chamadas de sha256_update
+static void test_split_updates(void) {
+    uint8_t message[1000];
+    for (size_t i = 0; i < sizeof(message); i++) {
+        message[i] = (uint8_t)i;
+    }
+    uint8_t expected[SHA256_DIGEST_SIZE];
+    sha256(message, sizeof(message), expected);
+
+    static const size_t chunks[] = { 1, 3, 55, 63, 64, 65, 127, 999 };
+    for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+        sha256_t ctx;
+        uint8_t digest[SHA256_DIGEST_SIZE];
+        sha256_init(&ctx);
+        for (size_t offset = 0; offset < sizeof(message); offset += chunks[c]) {
+            size_t len = sizeof(message) - offset < chunks[c] ? sizeof(message) - offset : chunks[c];
+            sha256_update(&ctx, message + offset, len);
+        }
+        sha256_final(&ctx, digest);
+        CHECK(memcmp(digest, expected, sizeof(digest)) == 0);
+    }
+
+    char hex[2 * SHA256_DIGEST_SIZE + 1];
+    to_hex(expected, hex);
+    CHECK(strcmp(hex, "a8af099bf2e878609558dbf69d8f88f4a31040a8cf84b549a0cfa912f12ffc3f") == 0);
+}
+
+int main(void) {
+    test_vectors();
+    test_split_updates();
+    return check_result();
+}
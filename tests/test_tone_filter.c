@@ -0,0 +1,166 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "check.h"
+#include "tone_filter.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Mesmos parâmetros da captura em baba_eletronica.c
+#define RATE 16000.0f
+#define COUNT 128
+#define VOLTS (3.3f / 4095)
+#define OFFSET 2048.0f
+
+static uint16_t samples[COUNT];
+
+// Ruído gaussiano (Box-Muller) com desvio em contagens do ADC
+static float gaussian(void) {
+    float u = (rand() + 1.0f) / (RAND_MAX + 2.0f);
+    float v = (rand() + 1.0f) / (RAND_MAX + 2.0f);
+    return sqrtf(-2.0f * logf(u)) * cosf(2.0f * (float)M_PI * v);
+}
+
+// Onda retangular do buzzer (duty em %) até o harmônico indicado, mais ruído. O caminho
+// buzzer -> microfone atenua os harmônicos altos; o filtro só cancela os TONE_FILTER_HARMONICS primeiros.
+static void synth_harmonics(uint32_t tone, uint32_t duty, uint32_t harmonics, float tone_counts,
+                            float noise_counts, float phase) {
+    for (int i = 0; i < COUNT; i++) {
+        float value = OFFSET + noise_counts * gaussian();
+        for (uint32_t h = 1; tone != 0 && h <= harmonics; h++) {
+            float weight = 2.0f / ((float)M_PI * h) * sinf((float)M_PI * h * duty / 100.0f);
+            value += tone_counts * weight * cosf(2.0f * (float)M_PI * h * (phase + tone * i / RATE));
+        }
+        samples[i] = (uint16_t)lrintf(value);
+    }
+}
+
+static void synth(uint32_t tone, uint32_t duty, float tone_counts, float noise_counts, float phase) {
+    synth_harmonics(tone, duty, TONE_FILTER_HARMONICS, tone_counts, noise_counts, phase);
+}
+
+static float level(const uint32_t *tones, uint32_t tone_count) {
+    return tone_filter_residual_level(samples, COUNT, RATE, tones, tone_count, VOLTS);
+}
+
+// Média do nível em vários blocos
+static float mean_level(uint32_t tone, uint32_t duty, float tone_counts, float noise_counts,
+                        const uint32_t *tones, uint32_t tone_count) {
+    float sum = 0.0f;
+    for (int block = 0; block < 200; block++) {
+        synth(tone, duty, tone_counts, noise_counts, block * 0.137f);
+        sum += level(tones, tone_count);
+    }
+    return sum / 200;
+}
+
+static void test_silence(void) {
+    synth(0, 0, 0, 0, 0);
+    uint32_t tones[2] = { 0, 0 };
+    CHECK(level(tones, 2) < 1e-6f);
+}
+
+static void test_pure_sine_is_cancelled(void) {
+    // Frequência sem número inteiro de ciclos no bloco
+    for (int i = 0; i < COUNT; i++) {
+        samples[i] = (uint16_t)lrintf(OFFSET + 400.0f * sinf(2.0f * (float)M_PI * 523.0f * i / RATE + 0.3f));
+    }
+    uint32_t none[2] = { 0, 0 };
+    uint32_t tones[2] = { 523, 0 };
+    float before = level(none, 2);
+    float after = level(tones, 2);
+    CHECK(fabsf(before - 400.0f * VOLTS) < 0.03f * 400.0f * VOLTS);
+    CHECK(after < 0.01f * before);  // Sobra só a quantização
+}
+
+static void test_square_wave_is_cancelled(void) {
+    // Nota alta com duty baixo: harmônicos pares e rebatidos acima de Nyquist
+    uint32_t tones[2] = { 1568, 0 };
+    uint32_t none[2] = { 0, 0 };
+    synth(1568, 25, 600.0f, 0.0f, 0.2f);
+    float before = level(none, 2);
+    float after = level(tones, 2);
+    CHECK(after < 0.01f * before);
+
+    // Harmônicos além de TONE_FILTER_HARMONICS ficam no resíduo
+    synth_harmonics(1568, 25, TONE_FILTER_HARMONICS + 4, 600.0f, 0.0f, 0.2f);
+    float beyond = level(tones, 2);
+    CHECK(beyond > 10.0f * after);
+    CHECK(beyond < 0.3f * before);
+}
+
+static void test_note_change_during_block(void) {
+    for (int i = 0; i < COUNT; i++) {
+        uint32_t tone = i < COUNT / 2 ? 440 : 659;
+        samples[i] = (uint16_t)lrintf(OFFSET + 300.0f * sinf(2.0f * (float)M_PI * tone * i / RATE));
+    }
+    uint32_t none[2] = { 0, 0 };
+    uint32_t both[2] = { 440, 659 };
+    uint32_t same[2] = { 440, 440 };
+    // Cada nota ocupa só metade do bloco: o ajuste de senoides do bloco inteiro remove
+    // pouco (limitação conhecida), mas considerar as duas notas remove mais que uma só
+    float before = level(none, 2);
+    CHECK(level(same, 2) < before);
+    CHECK(level(both, 2) < level(same, 2));
+}
+
+static void test_noise_level_independent_of_tone(void) {
+    // O nível do ruído não pode cair por causa das componentes removidas: o limiar
+    // calibrado sem melodia vale também durante a melodia
+    uint32_t none[2] = { 0, 0 };
+    uint32_t tones[2] = { 262, 392 };
+    float quiet = mean_level(0, 0, 0.0f, 30.0f, none, 2);
+    float filtered = mean_level(0, 0, 0.0f, 30.0f, tones, 2);
+    printf("ruido: %.4f V sem tom, %.4f V cancelando 2 tons\n", quiet, filtered);
+    CHECK(fabsf(quiet - sqrtf(2.0f) * 30.0f * VOLTS) < 0.05f * quiet);
+    CHECK(fabsf(filtered - quiet) < 0.05f * quiet);
+}
+
+static void test_cry_detected_over_melody(void) {
+    // Ruído forte (choro) sobre a música continua acima do nível do ruído de fundo
+    uint32_t tones[2] = { 523, 0 };
+    uint32_t none[2] = { 0, 0 };
+    float background = mean_level(0, 0, 0.0f, 20.0f, none, 2);
+    float melody = mean_level(523, 50, 500.0f, 20.0f, tones, 2);
+    float cry = mean_level(523, 50, 500.0f, 120.0f, tones, 2);
+    CHECK(melody < 1.5f * background);
+    CHECK(cry > 4.0f * background);
+}
+
+static void test_cost(void) {
+    // Custo relativo no computador; o custo no RP2040 aparece em GET /stats (tone_filter)
+    uint32_t tones[2] = { 1568, 1175 };
+    synth(1568, 25, 600.0f, 20.0f, 0.0f);
+    const int runs = 2000;
+    clock_t start = clock();
+    volatile float sink = 0.0f;
+    for (int i = 0; i < runs; i++) {
+        sink += level(tones, 2);
+    }
+    double us = (double)(clock() - start) * 1e6 / CLOCKS_PER_SEC / runs;
+    // Troca de nota a cada bloco: a base é refeita sempre
+    uint32_t other[2] = { 1175, 1568 };
+    start = clock();
+    for (int i = 0; i < runs; i++) {
+        sink += level((i & 1) ? other : tones, 2);
+    }
+    double rebuild_us = (double)(clock() - start) * 1e6 / CLOCKS_PER_SEC / runs;
+    printf("%.1f us por bloco de %d amostras com 2 tons, %.1f us com troca de nota (computador)\n",
+           us, COUNT, rebuild_us);
+    CHECK(sink > 0.0f);
+}
+
+int main(void) {
+    srand(1);
+    test_silence();
+    test_pure_sine_is_cancelled();
+    test_square_wave_is_cancelled();
+    test_note_change_during_block();
+    test_noise_level_independent_of_tone();
+    test_cry_detected_over_melody();
+    test_cost();
+    return check_result();
+}
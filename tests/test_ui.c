@@ -0,0 +1,309 @@
+#include <stdlib.h>
+#include <string.h>
+#include "check.h"
+#include "ssd1306.h"
+#include "ui.h"
+
+// Controlador SSD1306 emulado: recebe os bytes do I2C, segue os comandos de janela
+// (0x21 colunas, 0x22 páginas) e grava os dados na GDDRAM com o mesmo avanço do display.
+i2c_inst_t *i2c1 = NULL;
+
+typedef struct {
+    uint8_t page, first, last;
+} span_t;
+
+static uint8_t gddram[ssd1306_buffer_length];
+static uint8_t col_start, col_end, page_start, page_end, col, page;
+static uint8_t command, args[2], args_needed, args_count;
+static uint32_t data_bytes;
+static span_t spans[16];
+static int span_count;
+
+static const char *dump_dir = NULL;
+static int dump_index = 0;
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    if (len == 2 && src[0] == 0x80) {
+        if (args_needed > 0) {
+            args[args_count++] = src[1];
+            if (args_count == args_needed) {
+                if (command == ssd1306_set_column_address) {
+                    col_start = col = args[0];
+                    col_end = args[1];
+                } else {
+                    page_start = page = args[0];
+                    page_end = args[1];
+                }
+                args_needed = 0;
+            }
+        } else if (src[1] == ssd1306_set_column_address || src[1] == ssd1306_set_page_address) {
+            command = src[1];
+            args_needed = 2;
+            args_count = 0;
+        }
+        return 2;
+    }
+    if (len > 0 && src[0] == 0x40) {
+        if (span_count < (int)count_of(spans)) {
+            spans[span_count++] = (span_t){ page, col, (uint8_t)(col + len - 2) };
+        }
+        for (size_t i = 1; i < len; i++) {
+            gddram[page * ssd1306_width + col] = src[i];
+            data_bytes++;
+            if (col == col_end) {
+                col = col_start;
+                page = page == page_end ? page_start : page + 1;
+            } else {
+                col++;
+            }
+        }
+    }
+    return (int)len;
+}
+
+// Com um diretório na linha de comando, grava cada quadro do display como PBM (128x64)
+static void dump(const char *name) {
+    if (dump_dir == NULL) {
+        return;
+    }
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%02d_%s.pbm", dump_dir, dump_index++, name);
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        fprintf(stderr, "nao foi possivel criar %s\n", path);
+        return;
+    }
+    fprintf(file, "P1\n%d %d\n", ssd1306_width, ssd1306_height);
+    for (int y = 0; y < ssd1306_height; y++) {
+        for (int x = 0; x < ssd1306_width; x++) {
+            fputc(gddram[(y / 8) * ssd1306_width + x] & (1 << (y % 8)) ? '1' : '0', file);
+        }
+        fputc('\n', file);
+    }
+    fclose(file);
+}
+
+static void reset_counters(void) {
+    data_bytes = 0;
+    span_count = 0;
+}
+
+// Cada faixa enviada começa e termina numa coluna alterada: nada além do necessário
+static bool spans_are_tight(const uint8_t *before) {
+    for (int i = 0; i < span_count; i++) {
+        const uint8_t *old = &before[spans[i].page * ssd1306_width];
+        const uint8_t *now = &gddram[spans[i].page * ssd1306_width];
+        if (old[spans[i].first] == now[spans[i].first] || old[spans[i].last] == now[spans[i].last]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Retângulo de referência (mesma geometria da barra do ui.c)
+static void draw_rect(uint8_t *frame, int x, int y, int width, int height, bool fill) {
+    for (int i = 0; i < width; i++) {
+        for (int j = 0; j < height; j++) {
+            if (fill || i == 0 || j == 0 || i == width - 1 || j == height - 1) {
+                ssd1306_set_pixel(frame, x + i, y + j, true);
+            }
+        }
+    }
+}
+
+static uint32_t now;
+
+static void start(void) {
+    memset(gddram, 0xAA, sizeof(gddram));  // Lixo: o ui_init deve limpar tudo
+    reset_counters();
+    ui_init();
+    now = 1000;
+}
+
+static void test_init_clears_display(void) {
+    start();
+    uint8_t expected[ssd1306_buffer_length] = { 0 };
+    CHECK(memcmp(gddram, expected, sizeof(gddram)) == 0);
+    CHECK(data_bytes == ssd1306_buffer_length);
+    CHECK(span_count == 1);
+    CHECK(ui_render(now) == false);  // Nenhum widget: o quadro vazio já está no display
+    dump("vazio");
+}
+
+static void test_label_sends_changed_columns(void) {
+    start();
+    int label = ui_add_label(0, 16, 8);
+    ui_set_text(label, "AB");
+    reset_counters();
+    uint8_t before[ssd1306_buffer_length];
+    memcpy(before, gddram, sizeof(before));
+    CHECK(ui_render(now));
+
+    uint8_t expected[ssd1306_buffer_length] = { 0 };
+    ssd1306_draw_string(expected, 16, 8, "AB");
+    CHECK(memcmp(gddram, expected, sizeof(gddram)) == 0);
+    CHECK(span_count == 1 && spans[0].page == 1);
+    CHECK(spans[0].first >= 16 && spans[0].last < 32);
+    CHECK(spans_are_tight(before));
+    dump("rotulo");
+
+    // Trocar só o segundo caractere envia apenas colunas do segundo glifo
+    ui_set_text(label, "AC");
+    now += UI_FRAME_MS;
+    reset_counters();
+    memcpy(before, gddram, sizeof(before));
+    CHECK(ui_render(now));
+    memset(expected, 0, sizeof(expected));
+    ssd1306_draw_string(expected, 16, 8, "AC");
+    CHECK(memcmp(gddram, expected, sizeof(gddram)) == 0);
+    CHECK(span_count == 1 && spans[0].first >= 24 && spans[0].last < 32);
+    CHECK(data_bytes <= 8);
+    CHECK(spans_are_tight(before));
+}
+
+static void test_frame_cap(void) {
+    start();
+    int label = ui_add_label(0, 0, 0);
+    ui_set_text(label, "1");
+    CHECK(ui_render(now));
+    uint32_t sent = ui_bytes_sent();
+
+    // Mudança antes de UI_FRAME_MS fica retida até o prazo
+    ui_set_text(label, "2");
+    CHECK(ui_render(now + 10) == false);
+    CHECK(ui_render(now + UI_FRAME_MS - 1) == false);
+    CHECK(ui_bytes_sent() == sent);
+    CHECK(ui_render(now + UI_FRAME_MS));
+    CHECK(ui_bytes_sent() > sent);
+    now += UI_FRAME_MS;
+
+    // Sem mudança nada é enviado, mesmo com o prazo vencido
+    sent = ui_bytes_sent();
+    CHECK(ui_render(now + 5 * UI_FRAME_MS) == false);
+    ui_set_text(label, "2");  // Mesmo texto não marca o quadro
+    CHECK(ui_render(now + 6 * UI_FRAME_MS) == false);
+
+    // Mudar e voltar antes do quadro: recompõe, mas não há diferença a enviar
+    ui_set_text(label, "3");
+    ui_set_text(label, "2");
+    CHECK(ui_render(now + 7 * UI_FRAME_MS) == false);
+    CHECK(ui_bytes_sent() == sent);
+}
+
+// O contador do ui_bytes_sent bate com os bytes que chegaram ao display
+static void test_bytes_sent_matches_bus(void) {
+    start();
+    uint32_t sent = ui_bytes_sent();
+    int label = ui_add_label(0, 0, 16);
+    ui_set_text(label, "Atividade: 5%%");
+    reset_counters();
+    CHECK(ui_render(now));
+    CHECK(ui_bytes_sent() - sent == data_bytes);
+}
+
+static void test_screens(void) {
+    start();
+    int all = ui_add_label(UI_ALL_SCREENS, 0, 0);
+    int first = ui_add_label(0, 0, 16);
+    int second = ui_add_label(1, 0, 24);
+    ui_set_text(all, "TOPO");
+    ui_set_text(first, "UM");
+    ui_set_text(second, "DOIS");
+    CHECK(ui_render(now));
+
+    uint8_t expected[ssd1306_buffer_length] = { 0 };
+    ssd1306_draw_string(expected, 0, 0, "TOPO");
+    ssd1306_draw_string(expected, 0, 16, "UM");
+    CHECK(memcmp(gddram, expected, sizeof(gddram)) == 0);
+
+    // Trocar de tela apaga só a página que some e desenha a nova; a barra comum não é reenviada
+    ui_show(1);
+    reset_counters();
+    CHECK(ui_render(now + UI_FRAME_MS));
+    memset(expected, 0, sizeof(expected));
+    ssd1306_draw_string(expected, 0, 0, "TOPO");
+    ssd1306_draw_string(expected, 0, 24, "DOIS");
+    CHECK(memcmp(gddram, expected, sizeof(gddram)) == 0);
+    CHECK(span_count == 2);
+    for (int i = 0; i < span_count; i++) {
+        CHECK(spans[i].page == 2 || spans[i].page == 3);
+    }
+    CHECK(ui_current_screen() == 1);
+    dump("tela_1");
+}
+
+static void test_bar_and_sparkline(void) {
+    start();
+    int bar = ui_add_bar(0, 0, 24, ssd1306_width, 8);
+    int spark = ui_add_sparkline(0, 0, 40, ssd1306_width, 16);
+    ui_set_value(bar, 50);
+    ui_push_sample(spark, 0);
+    ui_push_sample(spark, 100);
+    CHECK(ui_render(now));
+
+    uint8_t expected[ssd1306_buffer_length] = { 0 };
+    draw_rect(expected, 0, 24, ssd1306_width, 8, false);
+    draw_rect(expected, 2, 26, (ssd1306_width - 4) * 50 / 100, 4, true);
+    ssd1306_draw_line(expected, ssd1306_width - 2, 55, ssd1306_width - 1, 40, true);
+    CHECK(memcmp(gddram, expected, sizeof(gddram)) == 0);
+    dump("barra_sparkline");
+
+    // A barra crescendo envia só as colunas novas do preenchimento
+    ui_set_value(bar, 60);
+    reset_counters();
+    uint8_t before[ssd1306_buffer_length];
+    memcpy(before, gddram, sizeof(before));
+    CHECK(ui_render(now + UI_FRAME_MS));
+    draw_rect(expected, 2, 26, (ssd1306_width - 4) * 60 / 100, 4, true);
+    CHECK(memcmp(gddram, expected, sizeof(gddram)) == 0);
+    CHECK(span_count == 1 && spans[0].page == 3);
+    CHECK(data_bytes == (uint32_t)((ssd1306_width - 4) * 60 / 100 - (ssd1306_width - 4) * 50 / 100));
+    CHECK(spans_are_tight(before));
+}
+
+// Layout do firmware (baba_eletronica.c): mudar um dígito envia poucos bytes
+static void test_firmware_layout(void) {
+    start();
+    int icon_wifi = ui_add_icon(UI_ALL_SCREENS, 0, 0);
+    int state = ui_add_label(UI_ALL_SCREENS, 48, 0);
+    int message = ui_add_label(UI_ALL_SCREENS, 0, 56);
+    int headline = ui_add_label(0, 0, 16);
+    int level = ui_add_bar(0, 0, 24, ssd1306_width, 8);
+    int activity = ui_add_label(0, 0, 32);
+    int history = ui_add_sparkline(0, 0, 40, ssd1306_width, 16);
+    ui_set_icon(icon_wifi, UI_ICON_WIFI);
+    ui_set_text(state, "Ativo");
+    ui_set_text(message, "192.168.0.42");
+    ui_set_text(headline, "Sistema ativado");
+    ui_set_value(level, 35);
+    ui_set_text(activity, "Atividade: 5%%");
+    for (int i = 0; i < 200; i++) {
+        ui_push_sample(history, (uint8_t)(i * 7 % 60));
+    }
+    CHECK(ui_render(now));
+    dump("layout");
+
+    ui_set_text(activity, "Atividade: 6%%");
+    reset_counters();
+    uint8_t before[ssd1306_buffer_length];
+    memcpy(before, gddram, sizeof(before));
+    CHECK(ui_render(now + UI_FRAME_MS));
+    CHECK(span_count == 1 && spans[0].page == 4);
+    CHECK(data_bytes <= 8);
+    CHECK(spans_are_tight(before));
+    dump("layout_digito");
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1) {
+        dump_dir = argv[1];
+    }
+    test_init_clears_display();
+    test_label_sends_changed_columns();
+    test_frame_cap();
+    test_bytes_sent_matches_bus();
+    test_screens();
+    test_bar_and_sparkline();
+    test_firmware_layout();
+    return check_result();
+}
@@ -0,0 +1,213 @@
+#!/usr/bin/env python3
+"""Teste de carga do webserver da Babá Eletrônica e medição dos pools do lwIP.
+
+Abre vários clientes simultâneos contra o aparelho, mede latência e falhas e compara o
+GET /stats (campo "net") antes e depois: uso máximo de cada pool, esgotamentos (err) e
+conexões recusadas. No fim sugere valores para o lwipopts.h a partir dos máximos medidos.
+
+Uso:
+  http_load.py baba-quarto.local                        8 clientes, 50 requisições cada
+  http_load.py 192.168.0.42 --clients 12 --requests 100 --path / --path /stats
+  http_load.py baba-quarto.local --slow 4               + 4 clientes que enviam a requisição
+                                                          aos poucos (ocupam conexões)
+  http_load.py baba-quarto.local --upload --token T     + uploads seguidos em POST /songs (mede
+                                                          o PBUF_POOL com o corpo na fila)
+  http_load.py baba-quarto.local --markdown             tabela para a seção de perfil de
+                                                          memória do Readme
+
+O upload envia um corpo inválido de 4 KB (zeros) ao slot 0: o aparelho recebe o corpo inteiro
+pela fila de upload e responde 400 sem gravar a flash.
+
+Os máximos (max) do lwIP só crescem desde o boot: para medir um cenário isolado,
+reinicie o aparelho antes da execução.
+"""
+
+import argparse
+import json
+import socket
+import statistics
+import sys
+import threading
+import time
+
+# Pool do lwIP -> opção do lwipopts.h que o dimensiona
+POOL_OPTIONS = {
+    "PBUF_POOL": "PBUF_POOL_SIZE",
+    "TCP_PCB": "MEMP_NUM_TCP_PCB",
+    "TCP_PCB_LISTEN": "MEMP_NUM_TCP_PCB_LISTEN",
+    "TCP_SEG": "MEMP_NUM_TCP_SEG",
+    "PBUF_REF/ROM": "MEMP_NUM_PBUF",
+    "UDP_PCB": "MEMP_NUM_UDP_PCB",
+    "SYS_TIMEOUT": "MEMP_NUM_SYS_TIMEOUT",
+    "ARP_QUEUE": "MEMP_NUM_ARP_QUEUE",
+}
+MARGIN = 1.25  # Folga sobre o máximo medido
+UPLOAD_SIZE = 4096  # FLASH_STORE_SONG_SLOT_SIZE
+
+
+def request(host, port, path, timeout):
+    """Faz um GET e retorna (status, segundos); status None em falha de conexão."""
+    start = time.monotonic()
+    try:
+        with socket.create_connection((host, port), timeout=timeout) as conn:
+            conn.sendall(("GET %s HTTP/1.1\r\nHost: %s\r\nConnection: close\r\n\r\n" % (path, host)).encode())
+            data = b""
+            while True:
+                chunk = conn.recv(4096)
+                if not chunk:
+                    break
+                data += chunk
+    except OSError:
+        return None, time.monotonic() - start, b""
+    status = data.split(b" ", 2)[1].decode() if data.startswith(b"HTTP/") else "?"
+    return status, time.monotonic() - start, data
+
+
+def get_stats(host, port, timeout):
+    status, _, data = request(host, port, "/stats", timeout)
+    if status != "200":
+        return None
+    body = data.split(b"\r\n\r\n", 1)[1]
+    return json.loads(body)["net"]
+
+
+def client(args, paths, results, lock):
+    for i in range(args.requests):
+        status, elapsed, _ = request(args.host, args.port, paths[i % len(paths)], args.timeout)
+        with lock:
+            results.append((status, elapsed))
+
+
+def upload_client(args, stop, results, lock):
+    """POST /songs seguidos, o mais rápido possível, para encher a janela TCP do upload."""
+    body = bytes(UPLOAD_SIZE)
+    head = ("POST /songs?slot=0 HTTP/1.1\r\nHost: %s\r\nAuthorization: Bearer %s\r\n"
+            "Content-Length: %d\r\nConnection: close\r\n\r\n" % (args.host, args.token, len(body))).encode()
+    while not stop.is_set():
+        start = time.monotonic()
+        try:
+            with socket.create_connection((args.host, args.port), timeout=args.timeout) as conn:
+                conn.sendall(head + body)
+                data = conn.recv(4096)
+            status = data.split(b" ", 2)[1].decode() if data.startswith(b"HTTP/") else "?"
+        except OSError:
+            status = None
+        with lock:
+            results.append((status, time.monotonic() - start))
+
+
+def slow_client(args, stop):
+    """Mantém uma conexão aberta enviando a requisição um byte por vez."""
+    text = ("GET / HTTP/1.1\r\nHost: %s\r\n\r\n" % args.host).encode()
+    while not stop.is_set():
+        try:
+            with socket.create_connection((args.host, args.port), timeout=args.timeout) as conn:
+                for byte in text:
+                    if stop.is_set():
+                        return
+                    conn.sendall(bytes([byte]))
+                    time.sleep(0.5)
+                conn.recv(4096)
+        except OSError:
+            time.sleep(0.5)
+
+
+def pool_table(before, after):
+    names = [p.get("name", "#%d" % i) for i, p in enumerate(after["memp"])]
+    rows = [("mem (MEM_SIZE)", after["mem"]["avail"], after["mem"]["max"],
+             after["mem"]["err"] - before["mem"]["err"], "MEM_SIZE")]
+    for name, b, a in zip(names, before["memp"], after["memp"]):
+        rows.append((name, a["avail"], a["max"], a["err"] - b["err"], POOL_OPTIONS.get(name)))
+    return rows
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("host")
+    parser.add_argument("--port", type=int, default=80)
+    parser.add_argument("--clients", type=int, default=8, help="clientes simultâneos (padrão 8)")
+    parser.add_argument("--requests", type=int, default=50, help="requisições por cliente (padrão 50)")
+    parser.add_argument("--path", action="append", help="rotas usadas em rodízio (padrão: / e /stats)")
+    parser.add_argument("--slow", type=int, default=0, help="clientes lentos ocupando conexões")
+    parser.add_argument("--upload", action="store_true", help="um cliente enviando uploads durante a carga")
+    parser.add_argument("--token", default="", help="token da API (exigido pelo --upload)")
+    parser.add_argument("--markdown", action="store_true", help="imprime a tabela no formato do Readme")
+    parser.add_argument("--timeout", type=float, default=10.0)
+    args = parser.parse_args()
+    if args.upload and not args.token:
+        parser.error("--upload exige --token")
+    paths = args.path or ["/", "/stats"]
+
+    before = get_stats(args.host, args.port, args.timeout)
+    if before is None:
+        print("GET /stats falhou: o aparelho está acessível?", file=sys.stderr)
+        return 1
+
+    results = []
+    uploads = []
+    lock = threading.Lock()
+    stop = threading.Event()
+    slow = [threading.Thread(target=slow_client, args=(args, stop), daemon=True) for _ in range(args.slow)]
+    if args.upload:
+        slow.append(threading.Thread(target=upload_client, args=(args, stop, uploads, lock), daemon=True))
+    workers = [threading.Thread(target=client, args=(args, paths, results, lock)) for _ in range(args.clients)]
+    start = time.monotonic()
+    for t in slow + workers:
+        t.start()
+    for t in workers:
+        t.join()
+    duration = time.monotonic() - start
+    stop.set()
+
+    time.sleep(1)
+    after = get_stats(args.host, args.port, args.timeout)
+    if after is None:
+        print("GET /stats falhou após a carga", file=sys.stderr)
+        return 1
+
+    latencies = sorted(elapsed for status, elapsed in results if status == "200")
+    failures = {}
+    for status, _ in results:
+        if status != "200":
+            failures[status or "conexao"] = failures.get(status or "conexao", 0) + 1
+
+    print("%d clientes (+%d lentos), %d requisições em %.1f s (%.1f req/s)" %
+          (args.clients, args.slow, len(results), duration, len(results) / duration))
+    if latencies:
+        p95 = latencies[min(len(latencies) - 1, int(len(latencies) * 0.95))]
+        print("latência: mediana %.0f ms, p95 %.0f ms, máx %.0f ms" %
+              (statistics.median(latencies) * 1000, p95 * 1000, latencies[-1] * 1000))
+    print("falhas: %s" % (", ".join("%s=%d" % kv for kv in sorted(failures.items())) or "nenhuma"))
+    print("conexões recusadas pelo servidor: %d" % (after["http_rejected"] - before["http_rejected"]))
+    if args.upload:
+        counts = {}
+        for status, _ in uploads:
+            counts[status or "conexao"] = counts.get(status or "conexao", 0) + 1
+        # 400 é o esperado: o corpo de zeros não é uma faixa válida
+        print("uploads: %s" % (", ".join("%s=%d" % kv for kv in sorted(counts.items())) or "nenhum"))
+    print()
+
+    if args.markdown:
+        print("| pool | opção | avail | max | err |")
+        print("|---|---|---|---|---|")
+        for name, avail, peak, err, option in pool_table(before, after):
+            if option:
+                print("| %s | `%s` | %d | %d | %d |" % (name, option, avail, peak, err))
+        return 0
+
+    print("%-16s %8s %8s %8s   sugestão" % ("pool", "avail", "max", "err"))
+    for name, avail, peak, err, option in pool_table(before, after):
+        hint = ""
+        if option:
+            if name.startswith("mem"):
+                hint = "%s %d" % (option, int(peak * MARGIN + 0.5))
+            else:
+                hint = "%s %d" % (option, max(1, int(peak * MARGIN + 0.999)))
+            if err > 0:
+                hint += "  (esgotou: aumente)"
+        print("%-16s %8d %8d %8d   %s" % (name, avail, peak, err, hint))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
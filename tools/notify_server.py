@@ -0,0 +1,203 @@
+#!/usr/bin/env python3
+"""Servidor substituto para testar as notificações da Babá Eletrônica (ver inc/notify.c).
+
+Atende, no computador da rede local, os dois protocolos do cliente:
+  http  recebe o POST com corpo JSON e responde 200 (ou 503 nas falhas simuladas)
+  mqtt  broker mínimo MQTT 3.1.1: CONNECT/CONNACK, PUBLISH QoS 1/PUBACK, PINGREQ, DISCONNECT
+
+Cada evento recebido é conferido (campos e tipos) e impresso com o intervalo desde o anterior,
+o que permite observar o agrupamento (NOTIFY_COALESCE_MS) e o backoff entre as tentativas.
+
+Uso:
+  notify_server.py http --port 8080              NOTIFY_PROTO_HTTP, NOTIFY_PORT 8080
+  notify_server.py mqtt --port 1883              NOTIFY_PROTO_MQTT, NOTIFY_PORT 1883
+  notify_server.py http --fail 3                 recusa as 3 primeiras entregas (testa o backoff)
+  notify_server.py mqtt --drop 2                 fecha a conexão sem PUBACK nas 2 primeiras
+"""
+
+import argparse
+import json
+import socket
+import struct
+import sys
+import time
+
+EVENT_FIELDS = {
+    "device": str,
+    "event": str,
+    "count": int,
+    "peak_activity": int,
+    "age_ms": int,
+    "duration_ms": int,
+}
+EVENTS = ("choro", "ativado", "desativado")
+
+
+class Stats:
+    def __init__(self, fail, drop):
+        self.fail = fail
+        self.drop = drop
+        self.received = 0
+        self.last = None
+
+    # Retorna True se a entrega deve ser aceita
+    def event(self, source, payload):
+        now = time.monotonic()
+        gap = "" if self.last is None else " (+%.1f s)" % (now - self.last)
+        self.last = now
+        self.received += 1
+        problems = check_event(payload)
+        status = "ok" if not problems else "INVALIDO: " + "; ".join(problems)
+        accept = True
+        if self.fail > 0:
+            self.fail -= 1
+            accept = False
+            status += " [falha simulada]"
+        print("#%d %s%s %s -> %s" % (self.received, source, gap, payload.decode(errors="replace"), status),
+              flush=True)
+        return accept
+
+
+def check_event(payload):
+    try:
+        event = json.loads(payload)
+    except ValueError as e:
+        return ["JSON invalido: %s" % e]
+    problems = []
+    for field, kind in EVENT_FIELDS.items():
+        if field not in event:
+            problems.append("falta %s" % field)
+        elif not isinstance(event[field], kind):
+            problems.append("%s com tipo errado" % field)
+    if event.get("event") not in EVENTS:
+        problems.append("evento desconhecido")
+    if isinstance(event.get("count"), int) and event["count"] < 1:
+        problems.append("count < 1")
+    if isinstance(event.get("peak_activity"), int) and not 0 <= event["peak_activity"] <= 100:
+        problems.append("peak_activity fora de 0..100")
+    return problems
+
+
+def recv_exact(conn, size):
+    data = b""
+    while len(data) < size:
+        chunk = conn.recv(size - len(data))
+        if not chunk:
+            raise ConnectionError("conexao encerrada")
+        data += chunk
+    return data
+
+
+# ---------- HTTP ----------
+
+def serve_http(conn, addr, stats):
+    data = b""
+    while b"\r\n\r\n" not in data:
+        chunk = conn.recv(1024)
+        if not chunk:
+            return
+        data += chunk
+    head, body = data.split(b"\r\n\r\n", 1)
+    lines = head.decode(errors="replace").split("\r\n")
+    headers = {}
+    for line in lines[1:]:
+        name, _, value = line.partition(":")
+        headers[name.strip().lower()] = value.strip()
+    length = int(headers.get("content-length", "0"))
+    body += recv_exact(conn, length - len(body)) if len(body) < length else b""
+    if not lines[0].startswith("POST "):
+        conn.sendall(b"HTTP/1.1 405 Method Not Allowed\r\nConnection: close\r\n\r\n")
+        return
+    if stats.drop > 0:
+        stats.drop -= 1
+        print("%s: conexao fechada sem resposta [falha simulada]" % addr[0], flush=True)
+        return
+    ok = stats.event("http %s %s" % (addr[0], lines[0].split()[1]), body[:length])
+    status = b"200 OK" if ok else b"503 Service Unavailable"
+    conn.sendall(b"HTTP/1.1 " + status + b"\r\nContent-Length: 0\r\nConnection: close\r\n\r\n")
+
+
+# ---------- MQTT ----------
+
+def mqtt_read_packet(conn):
+    header = recv_exact(conn, 1)[0]
+    length = 0
+    shift = 0
+    while True:
+        byte = recv_exact(conn, 1)[0]
+        length |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            break
+    return header >> 4, header & 0x0F, recv_exact(conn, length)
+
+
+def serve_mqtt(conn, addr, stats):
+    kind, _, body = mqtt_read_packet(conn)
+    if kind != 1:
+        return
+    name_len = struct.unpack(">H", body[:2])[0]
+    client_id_at = 2 + name_len + 4
+    id_len = struct.unpack(">H", body[client_id_at:client_id_at + 2])[0]
+    client_id = body[client_id_at + 2:client_id_at + 2 + id_len].decode(errors="replace")
+    print("%s: CONNECT client_id=%s" % (addr[0], client_id), flush=True)
+    conn.sendall(bytes([0x20, 2, 0, 0]))
+
+    while True:
+        kind, flags, body = mqtt_read_packet(conn)
+        if kind == 3:  # PUBLISH
+            qos = (flags >> 1) & 3
+            topic_len = struct.unpack(">H", body[:2])[0]
+            topic = body[2:2 + topic_len].decode(errors="replace")
+            rest = body[2 + topic_len:]
+            packet_id = None
+            if qos > 0:
+                packet_id = struct.unpack(">H", rest[:2])[0]
+                rest = rest[2:]
+            if qos != 1:
+                print("%s: PUBLISH com QoS %d (esperado 1)" % (addr[0], qos), flush=True)
+            if stats.drop > 0:
+                stats.drop -= 1
+                print("%s: conexao fechada sem PUBACK [falha simulada]" % addr[0], flush=True)
+                return
+            if stats.event("mqtt %s %s" % (addr[0], topic), rest) and packet_id is not None:
+                conn.sendall(bytes([0x40, 2]) + struct.pack(">H", packet_id))
+        elif kind == 12:  # PINGREQ
+            conn.sendall(bytes([0xD0, 0]))
+        elif kind == 14:  # DISCONNECT
+            return
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("proto", choices=("http", "mqtt"))
+    parser.add_argument("--port", type=int, help="padrão: 8080 (http) ou 1883 (mqtt)")
+    parser.add_argument("--fail", type=int, default=0, help="recusa as N primeiras entregas")
+    parser.add_argument("--drop", type=int, default=0, help="fecha a conexão sem responder N vezes")
+    args = parser.parse_args()
+
+    port = args.port or (8080 if args.proto == "http" else 1883)
+    stats = Stats(args.fail, args.drop)
+    serve = serve_http if args.proto == "http" else serve_mqtt
+
+    listener = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    listener.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    listener.bind(("0.0.0.0", port))
+    listener.listen(4)
+    print("Aguardando notificacoes %s na porta %d" % (args.proto, port), flush=True)
+    try:
+        while True:
+            conn, addr = listener.accept()
+            with conn:
+                conn.settimeout(120)
+                try:
+                    serve(conn, addr, stats)
+                except (ConnectionError, socket.timeout, struct.error, ValueError) as e:
+                    print("%s: %s" % (addr[0], e), flush=True)
+    except KeyboardInterrupt:
+        pass
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,264 @@
+#!/usr/bin/env python3
+"""Conversor de faixas para o formato compacto da Babá Eletrônica (ver inc/song.h).
+
+Entradas:
+  .txt  texto com cabeçalho (nome, andamento, repeticoes, volume) e notas no formato
+        NOTA/FIGURA[.][@VOL], ex.: D5/8. FS5/16 R/4 A4/2@8
+  .mid  arquivo MIDI (formato 0 ou 1); as notas de todas as trilhas viram uma linha
+        monofônica (uma nota nova interrompe a anterior)
+
+Uso:
+  songc.py -o song_library.c songs/*.txt    gera a biblioteca embutida no firmware
+  songc.py --bin ninar.sng songs/ninar.txt  gera uma faixa para POST /songs?slot=N
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+MAGIC = b"SG"
+VERSION = 1
+NAME_MAX = 12
+FIGURES = {1: 0, 2: 1, 4: 2, 8: 3, 16: 4, 32: 5}
+MIDI_MIN = 23  # B0 (31 Hz): mais grave que isso não cabe no contador de 16 bits do PWM (SONG_MIDI_MIN)
+MIDI_MAX = 127
+SEMITONES = {"C": 0, "D": 2, "E": 4, "F": 5, "G": 7, "A": 9, "B": 11}
+
+
+class SongError(Exception):
+    pass
+
+
+def note_to_midi(name):
+    """Converte nomes como C4, FS5 ou C#5 em número MIDI (C4 = 60)."""
+    letter = name[0].upper()
+    if letter not in SEMITONES:
+        raise SongError("nota invalida: %s" % name)
+    rest = name[1:]
+    semitone = SEMITONES[letter]
+    if rest[:1] in ("S", "s", "#"):
+        semitone += 1
+        rest = rest[1:]
+    try:
+        octave = int(rest)
+    except ValueError:
+        raise SongError("oitava invalida: %s" % name)
+    midi = 12 * (octave + 1) + semitone
+    if not MIDI_MIN <= midi <= MIDI_MAX:
+        raise SongError("nota fora da faixa do buzzer (B0 a G9): %s" % name)
+    return midi
+
+
+def pack_duration(code, dotted, volume):
+    return code | (0x08 if dotted else 0) | (volume << 4)
+
+
+def parse_text(path):
+    song = {"name": os.path.splitext(os.path.basename(path))[0], "tempo": 120,
+            "repeats": 1, "volume": 100, "notes": []}
+    with open(path, encoding="utf-8") as source:
+        for number, line in enumerate(source, 1):
+            line = line.split("#", 1)[0].strip()
+            if not line:
+                continue
+            key, _, value = line.partition(" ")
+            try:
+                if key == "nome":
+                    song["name"] = value.strip()
+                elif key == "andamento":
+                    song["tempo"] = int(value)
+                elif key == "repeticoes":
+                    song["repeats"] = int(value)
+                elif key == "volume":
+                    song["volume"] = int(value)
+                else:
+                    for token in line.split():
+                        song["notes"].append(parse_token(token))
+            except (SongError, ValueError) as error:
+                raise SongError("%s:%d: %s" % (path, number, error))
+    return song
+
+
+def parse_token(token):
+    note, _, duration = token.partition("/")
+    if not duration:
+        raise SongError("figura ausente: %s" % token)
+    duration, _, volume = duration.partition("@")
+    dotted = duration.endswith(".")
+    figure = int(duration.rstrip("."))
+    if figure not in FIGURES:
+        raise SongError("figura invalida: %s" % token)
+    volume = int(volume) if volume else 15
+    if not 0 <= volume <= 15:
+        raise SongError("volume da nota deve estar entre 0 e 15: %s" % token)
+    midi = 0 if note.upper() == "R" else note_to_midi(note)
+    return midi, pack_duration(FIGURES[figure], dotted, volume)
+
+
+def read_varlen(data, pos):
+    value = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value = (value << 7) | (byte & 0x7F)
+        if not byte & 0x80:
+            return value, pos
+
+
+def parse_midi(path):
+    with open(path, "rb") as source:
+        data = source.read()
+    if data[:4] != b"MThd":
+        raise SongError("%s: nao e um arquivo MIDI" % path)
+    header_len, _, tracks, division = struct.unpack(">IHHH", data[4:14])
+    if division & 0x8000:
+        raise SongError("%s: divisao SMPTE nao suportada" % path)
+
+    events = []
+    tempo_us = 500000
+    pos = 8 + header_len
+    for _ in range(tracks):
+        if data[pos:pos + 4] != b"MTrk":
+            raise SongError("%s: trilha invalida" % path)
+        length = struct.unpack(">I", data[pos + 4:pos + 8])[0]
+        pos += 8
+        end = pos + length
+        tick = 0
+        status = 0
+        while pos < end:
+            delta, pos = read_varlen(data, pos)
+            tick += delta
+            if data[pos] & 0x80:
+                status = data[pos]
+                pos += 1
+            if status == 0xFF:
+                meta = data[pos]
+                length, pos = read_varlen(data, pos + 1)
+                if meta == 0x51 and tick == 0:
+                    tempo_us = int.from_bytes(data[pos:pos + 3], "big")
+                pos += length
+            elif status in (0xF0, 0xF7):
+                length, pos = read_varlen(data, pos)
+                pos += length
+            else:
+                kind = status & 0xF0
+                size = 1 if kind in (0xC0, 0xD0) else 2
+                args = data[pos:pos + size]
+                pos += size
+                if kind == 0x90 and args[1] > 0:
+                    events.append((tick, 1, args[0], args[1]))
+                elif kind == 0x80 or (kind == 0x90 and args[1] == 0):
+                    events.append((tick, 0, args[0], 0))
+        pos = end
+
+    # Linha monofônica: (início, fim, nota, velocidade)
+    events.sort()
+    spans = []
+    current = None
+    for tick, on, note, velocity in events:
+        if on:
+            if current:
+                spans.append((current[0], tick, current[1], current[2]))
+            current = (tick, note, velocity)
+        elif current and current[1] == note:
+            spans.append((current[0], tick, current[1], current[2]))
+            current = None
+
+    notes = []
+    cursor = 0
+    for start, end, note, velocity in spans:
+        if start > cursor:
+            notes.extend(quantize(start - cursor, division, 0, 15))
+        notes.extend(quantize(end - start, division, note, min(15, velocity // 8)))
+        cursor = end
+
+    bpm = max(1, min(255, round(60000000 / tempo_us)))
+    return {"name": os.path.splitext(os.path.basename(path))[0], "tempo": bpm,
+            "repeats": 1, "volume": 100, "notes": notes}
+
+
+def quantize(ticks, division, midi, volume):
+    """Divide uma duração em figuras (pontuadas ou não), da maior para a menor."""
+    options = []
+    for code in range(6):
+        base = division * 4 / (1 << code)
+        options.append((base * 1.5, code, True))
+        options.append((base, code, False))
+    options.sort(reverse=True)
+
+    result = []
+    remaining = ticks
+    smallest = options[-1][0]
+    while remaining >= smallest / 2:
+        length, code, dotted = next((o for o in options if o[0] <= remaining), options[-1])
+        result.append((midi, pack_duration(code, dotted, volume)))
+        remaining -= length
+    return result
+
+
+def pack(song):
+    name = song["name"].encode("ascii")
+    if len(name) >= NAME_MAX:
+        raise SongError("nome muito longo (max %d): %s" % (NAME_MAX - 1, song["name"]))
+    if not 1 <= song["tempo"] <= 255 or not 0 <= song["repeats"] <= 255 or not 0 <= song["volume"] <= 100:
+        raise SongError("%s: andamento, repeticoes ou volume fora da faixa" % song["name"])
+    if not song["notes"] or len(song["notes"]) > 0xFFFF:
+        raise SongError("%s: numero de notas invalido" % song["name"])
+    for midi, _ in song["notes"]:
+        if midi != 0 and not MIDI_MIN <= midi <= MIDI_MAX:
+            raise SongError("%s: nota MIDI %d fora da faixa do buzzer (%d a %d)" %
+                            (song["name"], midi, MIDI_MIN, MIDI_MAX))
+    header = MAGIC + struct.pack("<BBBBH", VERSION, song["tempo"], song["repeats"],
+                                 song["volume"], len(song["notes"]))
+    header += name.ljust(NAME_MAX, b"\0")
+    return header + b"".join(bytes(note) for note in song["notes"])
+
+
+def load(path):
+    return parse_midi(path) if path.lower().endswith((".mid", ".midi")) else parse_text(path)
+
+
+def write_library(paths, output):
+    lines = ["// Gerado por tools/songc.py - nao editar", "#include \"inc/song.h\"", ""]
+    names = []
+    for index, path in enumerate(paths):
+        packed = pack(load(path))
+        symbol = "song_data_%d" % index
+        names.append(symbol)
+        lines.append("// %s (%d bytes)" % (os.path.basename(path), len(packed)))
+        lines.append("static const uint8_t %s[] = {" % symbol)
+        for offset in range(0, len(packed), 16):
+            lines.append("    " + ", ".join("0x%02x" % b for b in packed[offset:offset + 16]) + ",")
+        lines.append("};")
+        lines.append("")
+    lines.append("const uint8_t *const song_builtin[] = {")
+    lines.extend("    %s," % name for name in names)
+    lines.append("};")
+    lines.append("const uint song_builtin_count = %d;" % len(names))
+    with open(output, "w", encoding="utf-8") as target:
+        target.write("\n".join(lines) + "\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("inputs", nargs="+")
+    group = parser.add_mutually_exclusive_group(required=True)
+    group.add_argument("-o", "--output", help="arquivo C da biblioteca embutida")
+    group.add_argument("--bin", help="faixa binaria para upload (uma entrada)")
+    args = parser.parse_args()
+
+    try:
+        if args.output:
+            write_library(args.inputs, args.output)
+        else:
+            if len(args.inputs) != 1:
+                raise SongError("--bin aceita uma unica entrada")
+            with open(args.bin, "wb") as target:
+                target.write(pack(load(args.inputs[0])))
+    except SongError as error:
+        sys.exit("songc: %s" % error)
+
+
+if __name__ == "__main__":
+    main()